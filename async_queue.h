@@ -0,0 +1,332 @@
+#ifndef _CP_ASYNC_QUEUE_INCLUDED_
+#define _CP_ASYNC_QUEUE_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+//#pragma once
+
+namespace CP
+{
+
+	// minimal single-threaded executor: a FIFO of coroutines that are ready to run
+	class event_loop
+	{
+	protected:
+		std::deque<std::coroutine_handle<>> mReady;
+
+	public:
+		void post(std::coroutine_handle<> h)
+		{
+			mReady.push_back(h);
+		}
+
+		bool empty() const
+		{
+			return mReady.empty();
+		}
+
+		// resumes one ready coroutine, returns false when there is none
+		bool run_one()
+		{
+			if (mReady.empty())
+				return false;
+			std::coroutine_handle<> h = mReady.front();
+			mReady.pop_front();
+			h.resume();
+			return true;
+		}
+
+		// runs until no coroutine is ready
+		void run()
+		{
+			while (run_one())
+				;
+		}
+	};
+
+	// fire-and-forget coroutine, started on an event_loop with spawn()
+	// the frame destroys itself when the coroutine finishes
+	class async_task
+	{
+	public:
+		struct promise_type
+		{
+			async_task get_return_object()
+			{
+				return async_task(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+			std::suspend_always initial_suspend() noexcept { return {}; }
+			std::suspend_never final_suspend() noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() { std::terminate(); }
+		};
+
+	protected:
+		std::coroutine_handle<promise_type> mHandle;
+
+	public:
+		explicit async_task(std::coroutine_handle<promise_type> h) : mHandle(h) {}
+
+		async_task(async_task &&other) noexcept : mHandle(other.mHandle)
+		{
+			other.mHandle = nullptr;
+		}
+
+		async_task(const async_task &) = delete;
+		async_task &operator=(const async_task &) = delete;
+
+		// a task that was never spawned is destroyed with its owner
+		~async_task()
+		{
+			if (mHandle)
+				mHandle.destroy();
+		}
+
+		void spawn(event_loop &loop)
+		{
+			loop.post(mHandle);
+			mHandle = nullptr;
+		}
+	};
+
+	// queue for coroutines on one event_loop
+	// co_await pop() suspends while the queue is empty and co_await push(x)
+	// suspends while a bounded queue is full. A push hands its value straight
+	// to the oldest waiting consumer and a pop pulls the oldest waiting
+	// producer's value in, so exactly one waiter is made ready per operation.
+	// A coroutine destroyed while suspended in pop() or push() leaves the
+	// queue with it
+	template <typename T>
+	class async_queue
+	{
+	protected:
+		struct pop_waiter
+		{
+			std::coroutine_handle<> handle;
+			std::optional<T> value;
+			pop_waiter *next;
+			bool linked;
+		};
+
+		struct push_waiter
+		{
+			std::coroutine_handle<> handle;
+			const T *value;
+			push_waiter *next;
+			bool linked;
+		};
+
+		event_loop &mLoop;
+		std::deque<T> mData;
+		size_t mCap; // 0 means unbounded
+		pop_waiter *mPopHead;
+		pop_waiter *mPopTail;
+		push_waiter *mPushHead;
+		push_waiter *mPushTail;
+
+		template <typename W>
+		static void enqueue(W *&head, W *&tail, W *w)
+		{
+			w->next = nullptr;
+			w->linked = true;
+			if (tail == nullptr)
+				head = w;
+			else
+				tail->next = w;
+			tail = w;
+		}
+
+		template <typename W>
+		static W *dequeue(W *&head, W *&tail)
+		{
+			W *w = head;
+			head = w->next;
+			if (head == nullptr)
+				tail = nullptr;
+			w->linked = false;
+			return w;
+		}
+
+		// unlinks a waiter whose coroutine is destroyed before it was resumed
+		template <typename W>
+		static void remove(W *&head, W *&tail, W *w)
+		{
+			W *prev = nullptr;
+			for (W *p = head; p != w; p = p->next)
+				prev = p;
+			if (prev == nullptr)
+				head = w->next;
+			else
+				prev->next = w->next;
+			if (tail == w)
+				tail = prev;
+			w->linked = false;
+		}
+
+		bool full() const
+		{
+			return mCap != 0 && mData.size() >= mCap;
+		}
+
+		// after a pop made room, move the oldest blocked producer in
+		void admit_producer()
+		{
+			if (mPushHead != nullptr && !full())
+			{
+				push_waiter *w = dequeue(mPushHead, mPushTail);
+				mData.push_back(*w->value);
+				mLoop.post(w->handle);
+			}
+		}
+
+	public:
+		class pop_awaiter
+		{
+			friend class async_queue;
+
+		protected:
+			async_queue &mQueue;
+			pop_waiter mWaiter;
+
+		public:
+			pop_awaiter(async_queue &q) : mQueue(q), mWaiter() {}
+
+			pop_awaiter(const pop_awaiter &) = delete;
+			pop_awaiter &operator=(const pop_awaiter &) = delete;
+
+			~pop_awaiter()
+			{
+				if (mWaiter.linked)
+					remove(mQueue.mPopHead, mQueue.mPopTail, &mWaiter);
+			}
+
+			bool await_ready()
+			{
+				if (mQueue.mData.empty())
+					return false;
+				mWaiter.value.emplace(std::move(mQueue.mData.front()));
+				mQueue.mData.pop_front();
+				mQueue.admit_producer();
+				return true;
+			}
+
+			void await_suspend(std::coroutine_handle<> h)
+			{
+				mWaiter.handle = h;
+				enqueue(mQueue.mPopHead, mQueue.mPopTail, &mWaiter);
+			}
+
+			T await_resume()
+			{
+				return std::move(*mWaiter.value);
+			}
+		};
+
+		class push_awaiter
+		{
+			friend class async_queue;
+
+		protected:
+			async_queue &mQueue;
+			const T &mValue;
+			push_waiter mWaiter;
+
+		public:
+			push_awaiter(async_queue &q, const T &v) : mQueue(q), mValue(v), mWaiter() {}
+
+			push_awaiter(const push_awaiter &) = delete;
+			push_awaiter &operator=(const push_awaiter &) = delete;
+
+			~push_awaiter()
+			{
+				if (mWaiter.linked)
+					remove(mQueue.mPushHead, mQueue.mPushTail, &mWaiter);
+			}
+
+			bool await_ready()
+			{
+				return mQueue.try_push(mValue);
+			}
+
+			void await_suspend(std::coroutine_handle<> h)
+			{
+				mWaiter.handle = h;
+				mWaiter.value = &mValue;
+				enqueue(mQueue.mPushHead, mQueue.mPushTail, &mWaiter);
+			}
+
+			void await_resume() {}
+		};
+
+		//-------------- constructor ----------
+		async_queue(event_loop &loop, size_t capacity = 0) : mLoop(loop), mCap(capacity),
+															 mPopHead(nullptr), mPopTail(nullptr),
+															 mPushHead(nullptr), mPushTail(nullptr) {}
+
+		async_queue(const async_queue<T> &) = delete;
+		async_queue<T> &operator=(const async_queue<T> &) = delete;
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mData.empty();
+		}
+
+		size_t size() const
+		{
+			return mData.size();
+		}
+
+		size_t capacity() const
+		{
+			return mCap;
+		}
+
+		//----------------- modifier -------------
+		// co_await q.pop()
+		pop_awaiter pop()
+		{
+			return pop_awaiter(*this);
+		}
+
+		// co_await q.push(x); x must stay alive until the push completes
+		push_awaiter push(const T &element)
+		{
+			return push_awaiter(*this, element);
+		}
+
+		// never suspends, false when a bounded queue is full
+		bool try_push(const T &element)
+		{
+			if (mPopHead != nullptr)
+			{
+				// a consumer is waiting, so the queue is empty: hand over directly
+				pop_waiter *w = dequeue(mPopHead, mPopTail);
+				w->value.emplace(element);
+				mLoop.post(w->handle);
+				return true;
+			}
+			if (full())
+				return false;
+			mData.push_back(element);
+			return true;
+		}
+
+		// never suspends, false when the queue is empty
+		bool try_pop(T &out)
+		{
+			if (mData.empty())
+				return false;
+			out = std::move(mData.front());
+			mData.pop_front();
+			admit_producer();
+			return true;
+		}
+	};
+}
+
+#endif
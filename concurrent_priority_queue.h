@@ -0,0 +1,179 @@
+#ifndef _CP_CONCURRENT_PRIORITY_QUEUE_INCLUDED_
+#define _CP_CONCURRENT_PRIORITY_QUEUE_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include "priority_queue.h"
+//#pragma once
+
+namespace CP
+{
+
+	// relaxed concurrent priority queue (MultiQueue)
+	// c * threads independent CP::priority_queue heaps, each behind its own
+	// try-lock. push() goes to a random heap; pop() locks two random heaps and
+	// takes the better of their tops. The element returned is not always the
+	// global top but is close to it: the expected rank error grows with the
+	// number of heaps, not with the number of elements
+	template <typename T, typename Comp = std::less<T>>
+	class concurrent_priority_queue
+	{
+	protected:
+		struct alignas(64) shard
+		{
+			std::atomic<bool> locked;
+			CP::priority_queue<T, Comp> heap;
+
+			shard() : locked(false) {}
+
+			bool try_lock()
+			{
+				return !locked.load(std::memory_order_relaxed) &&
+					   !locked.exchange(true, std::memory_order_acquire);
+			}
+
+			void lock()
+			{
+				while (!try_lock())
+					std::this_thread::yield();
+			}
+
+			void unlock()
+			{
+				locked.store(false, std::memory_order_release);
+			}
+		};
+
+		shard *mShards;
+		size_t mCount;
+		std::atomic<size_t> mSize;
+		Comp mLess;
+
+		static unsigned long long next_random()
+		{
+			static thread_local unsigned long long s =
+				0x9e3779b97f4a7c15ull ^ (unsigned long long)std::hash<std::thread::id>()(std::this_thread::get_id());
+			// xorshift64
+			s ^= s << 13;
+			s ^= s >> 7;
+			s ^= s << 17;
+			return s;
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// threads is the expected number of concurrent users, c the number of
+		// heaps per thread (more heaps: less contention, larger rank error)
+		concurrent_priority_queue(size_t threads = std::thread::hardware_concurrency(), size_t c = 2, const Comp &comp = Comp())
+			: mSize(0), mLess(comp)
+		{
+			mCount = std::max<size_t>(2, std::max<size_t>(1, threads) * std::max<size_t>(1, c));
+			mShards = new shard[mCount];
+			// the heaps order by the same comparator try_pop uses between them
+			for (size_t i = 0; i < mCount; i++)
+				mShards[i].heap = CP::priority_queue<T, Comp>(comp);
+		}
+
+		concurrent_priority_queue(const concurrent_priority_queue<T, Comp> &) = delete;
+		concurrent_priority_queue<T, Comp> &operator=(const concurrent_priority_queue<T, Comp> &) = delete;
+
+		~concurrent_priority_queue()
+		{
+			delete[] mShards;
+		}
+
+		//------------- capacity function -------------------
+		// only a snapshot while other threads are running
+		bool empty() const
+		{
+			return size() == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize.load(std::memory_order_relaxed);
+		}
+
+		size_t heaps() const
+		{
+			return mCount;
+		}
+
+		//----------------- modifier -------------
+		void push(const T &element)
+		{
+			while (true)
+			{
+				shard &s = mShards[next_random() % mCount];
+				if (s.try_lock())
+				{
+					s.heap.push(element);
+					// counted before a pop can see it, so mSize never drops below 0
+					mSize.fetch_add(1, std::memory_order_relaxed);
+					s.unlock();
+					return;
+				}
+			}
+		}
+
+		// takes the better top of two random heaps; false only when every
+		// heap was seen empty
+		bool try_pop(T &out)
+		{
+			for (int attempt = 0; attempt < 64 && size() > 0; attempt++)
+			{
+				size_t i = next_random() % mCount;
+				size_t j = next_random() % (mCount - 1);
+				if (j >= i)
+					j++;
+				shard &a = mShards[i];
+				shard &b = mShards[j];
+				bool la = a.try_lock();
+				bool lb = b.try_lock();
+				shard *best = nullptr;
+				if (la && !a.heap.empty())
+					best = &a;
+				if (lb && !b.heap.empty() && (best == nullptr || mLess(best->heap.top(), b.heap.top())))
+					best = &b;
+				if (best != nullptr)
+				{
+					out = best->heap.top();
+					best->heap.pop();
+					mSize.fetch_sub(1, std::memory_order_relaxed);
+				}
+				if (la)
+					a.unlock();
+				if (lb)
+					b.unlock();
+				if (best != nullptr)
+					return true;
+			}
+			// the sampled heaps kept coming up empty or busy, sweep all of them
+			size_t start = next_random() % mCount;
+			for (size_t k = 0; k < mCount; k++)
+			{
+				shard &s = mShards[(start + k) % mCount];
+				s.lock();
+				if (!s.heap.empty())
+				{
+					out = s.heap.top();
+					s.heap.pop();
+					s.unlock();
+					mSize.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+				s.unlock();
+			}
+			return false;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,427 @@
+#ifndef _CP_DEQUE_INCLUDED_
+#define _CP_DEQUE_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <type_traits>
+//#pragma once
+
+namespace CP
+{
+
+	// double-ended ring buffer
+	// same layout as CP::queue (mData, mFront, mSize) but the capacity is a
+	// power of two so positions wrap with a mask instead of a division
+	template <typename T>
+	class deque
+	{
+	protected:
+		T *mData;
+		size_t mCap;
+		size_t mSize;
+		size_t mFront;
+
+		size_t slot(size_t i) const
+		{
+			return (mFront + i) & (mCap - 1);
+		}
+
+		void expand(size_t capacity)
+		{
+			T *arr = new T[capacity]();
+			for (size_t i = 0; i < mSize; i++)
+			{
+				arr[i] = std::move(mData[slot(i)]);
+			}
+			delete[] mData;
+			mData = arr;
+			mCap = capacity;
+			mFront = 0;
+		}
+
+		void ensureCapacity(size_t capacity)
+		{
+			if (capacity > mCap)
+			{
+				size_t s = mCap;
+				while (s < capacity)
+					s *= 2;
+				expand(s);
+			}
+		}
+
+		void rangeCheck(size_t n) const
+		{
+			if (n >= mSize)
+				throw std::out_of_range("index of out range");
+		}
+
+		class deque_iterator
+		{
+			friend class deque;
+
+		protected:
+			deque<T> *mDeque;
+			size_t mIdx;
+
+		public:
+			deque_iterator() : mDeque(nullptr), mIdx(0) {}
+
+			deque_iterator(deque<T> *d, size_t idx) : mDeque(d), mIdx(idx) {}
+
+			deque_iterator &operator++()
+			{
+				mIdx++;
+				return (*this);
+			}
+
+			deque_iterator &operator--()
+			{
+				mIdx--;
+				return (*this);
+			}
+
+			deque_iterator operator++(int)
+			{
+				deque_iterator tmp(*this);
+				operator++();
+				return tmp;
+			}
+
+			deque_iterator operator--(int)
+			{
+				deque_iterator tmp(*this);
+				operator--();
+				return tmp;
+			}
+
+			deque_iterator operator+(std::ptrdiff_t n) const { return deque_iterator(mDeque, mIdx + n); }
+			deque_iterator operator-(std::ptrdiff_t n) const { return deque_iterator(mDeque, mIdx - n); }
+			std::ptrdiff_t operator-(const deque_iterator &other) const { return (std::ptrdiff_t)mIdx - (std::ptrdiff_t)other.mIdx; }
+			T &operator*() { return (*mDeque)[mIdx]; }
+			T *operator->() { return &(*mDeque)[mIdx]; }
+			bool operator==(const deque_iterator &other) const { return other.mIdx == mIdx && other.mDeque == mDeque; }
+			bool operator!=(const deque_iterator &other) const { return !(*this == other); }
+			bool operator<(const deque_iterator &other) const { return mIdx < other.mIdx; }
+		};
+
+	public:
+		typedef deque_iterator iterator;
+
+		//-------------- constructor ----------
+
+		// copy constructor
+		deque(const deque<T> &a) : mData(new T[a.mCap]()), mCap(a.mCap), mSize(a.mSize), mFront(0)
+		{
+			for (size_t i = 0; i < a.mSize; i++)
+			{
+				mData[i] = a.mData[a.slot(i)];
+			}
+		}
+
+		// default constructor
+		deque() : mData(new T[1]()), mCap(1), mSize(0), mFront(0) {}
+
+		// range constructor
+		template <typename InputIt>
+		deque(InputIt first, InputIt last) : deque()
+		{
+			append(first, last);
+		}
+
+		// copy assignment operator
+		deque<T> &operator=(deque<T> other)
+		{
+			using std::swap;
+			swap(mSize, other.mSize);
+			swap(mCap, other.mCap);
+			swap(mData, other.mData);
+			swap(mFront, other.mFront);
+			return *this;
+		}
+
+		~deque()
+		{
+			delete[] mData;
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		size_t capacity() const
+		{
+			return mCap;
+		}
+
+		void reserve(size_t n)
+		{
+			ensureCapacity(n);
+		}
+
+		//----------------- iterator ---------------
+		iterator begin()
+		{
+			return iterator(this, 0);
+		}
+
+		iterator end()
+		{
+			return iterator(this, mSize);
+		}
+
+		//----------------- access -----------------
+		T &operator[](size_t idx)
+		{
+			return mData[slot(idx)];
+		}
+
+		const T &operator[](size_t idx) const
+		{
+			return mData[slot(idx)];
+		}
+
+		T &at(size_t idx)
+		{
+			rangeCheck(idx);
+			return mData[slot(idx)];
+		}
+
+		const T &at(size_t idx) const
+		{
+			rangeCheck(idx);
+			return mData[slot(idx)];
+		}
+
+		const T &front() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mData[mFront];
+		}
+
+		const T &back() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mData[slot(mSize - 1)];
+		}
+
+		//----------------- modifier -------------
+		void push_back(const T &element)
+		{
+			ensureCapacity(mSize + 1);
+			mData[slot(mSize)] = element;
+			mSize++;
+		}
+
+		void push_front(const T &element)
+		{
+			ensureCapacity(mSize + 1);
+			mFront = (mFront + mCap - 1) & (mCap - 1);
+			mData[mFront] = element;
+			mSize++;
+		}
+
+		void pop_back()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			mSize--;
+		}
+
+		void pop_front()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			mFront = slot(1);
+			mSize--;
+		}
+
+		// shifts whichever side of pos is shorter
+		iterator insert(size_t pos, const T &element)
+		{
+			if (pos > mSize)
+				throw std::out_of_range("index of out range");
+			ensureCapacity(mSize + 1);
+			if (pos < mSize - pos)
+			{
+				mFront = (mFront + mCap - 1) & (mCap - 1);
+				mSize++;
+				for (size_t i = 0; i < pos; i++)
+				{
+					mData[slot(i)] = std::move(mData[slot(i + 1)]);
+				}
+			}
+			else
+			{
+				for (size_t i = mSize; i > pos; i--)
+				{
+					mData[slot(i)] = std::move(mData[slot(i - 1)]);
+				}
+				mSize++;
+			}
+			mData[slot(pos)] = element;
+			return iterator(this, pos);
+		}
+
+		iterator insert(iterator it, const T &element)
+		{
+			return insert(it.mIdx, element);
+		}
+
+		// shifts whichever side of pos is shorter
+		iterator erase(size_t pos)
+		{
+			rangeCheck(pos);
+			if (pos < mSize - 1 - pos)
+			{
+				for (size_t i = pos; i > 0; i--)
+				{
+					mData[slot(i)] = std::move(mData[slot(i - 1)]);
+				}
+				mFront = slot(1);
+			}
+			else
+			{
+				for (size_t i = pos; i + 1 < mSize; i++)
+				{
+					mData[slot(i)] = std::move(mData[slot(i + 1)]);
+				}
+			}
+			mSize--;
+			return iterator(this, pos);
+		}
+
+		iterator erase(iterator it)
+		{
+			return erase(it.mIdx);
+		}
+
+		void clear()
+		{
+			mSize = 0;
+			mFront = 0;
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		// appends a batch, growing at most once for forward iterators
+		template <typename InputIt>
+		void append(InputIt first, InputIt last)
+		{
+			if constexpr (std::is_base_of<std::forward_iterator_tag,
+										  typename std::iterator_traits<InputIt>::iterator_category>::value)
+			{
+				ensureCapacity(mSize + std::distance(first, last));
+			}
+			for (; first != last; ++first)
+			{
+				ensureCapacity(mSize + 1);
+				mData[slot(mSize)] = *first;
+				mSize++;
+			}
+		}
+
+		// the content as at most two contiguous pieces, oldest first
+		std::pair<std::pair<T *, size_t>, std::pair<T *, size_t>> spans()
+		{
+			size_t first = mCap - mFront;
+			if (first >= mSize)
+				return std::make_pair(std::make_pair(mData + mFront, mSize), std::make_pair(mData, (size_t)0));
+			return std::make_pair(std::make_pair(mData + mFront, first), std::make_pair(mData, mSize - first));
+		}
+
+		std::vector<T> to_vector(size_t k) const
+		{
+			std::vector<T> res;
+			if (k > mSize)
+				k = mSize;
+			res.reserve(k);
+			for (size_t i = 0; i < k; ++i)
+			{
+				res.push_back(mData[slot(i)]);
+			}
+			return res;
+		}
+
+		void move_to_front(size_t pos)
+		{
+			rangeCheck(pos);
+			T tem = std::move(mData[slot(pos)]);
+			for (size_t i = pos; i > 0; --i)
+			{
+				mData[slot(i)] = std::move(mData[slot(i - 1)]);
+			}
+			mData[mFront] = std::move(tem);
+		}
+
+		void move_to_back(size_t pos)
+		{
+			rangeCheck(pos);
+			T tem = std::move(mData[slot(pos)]);
+			for (size_t i = pos; i + 1 < mSize; ++i)
+			{
+				mData[slot(i)] = std::move(mData[slot(i + 1)]);
+			}
+			mData[slot(mSize - 1)] = std::move(tem);
+		}
+
+		// rotates left by k: element k becomes the front
+		void rotate(long long k)
+		{
+			if (mSize == 0)
+				return;
+			long long s = (long long)mSize;
+			k %= s;
+			if (k < 0)
+				k += s;
+			if (mSize == mCap)
+			{
+				// full ring, moving the front is enough
+				mFront = slot((size_t)k);
+				return;
+			}
+			if (k <= s - k)
+			{
+				for (long long i = 0; i < k; i++)
+				{
+					push_back(mData[mFront]);
+					pop_front();
+				}
+			}
+			else
+			{
+				for (long long i = 0; i < s - k; i++)
+				{
+					T tem = mData[slot(mSize - 1)];
+					pop_back();
+					push_front(tem);
+				}
+			}
+		}
+
+		bool operator==(const CP::deque<T> &other) const
+		{
+			if (mSize != other.mSize)
+				return false;
+			for (size_t i = 0; i < mSize; ++i)
+			{
+				if (mData[slot(i)] != other.mData[other.slot(i)])
+					return false;
+			}
+			return true;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,549 @@
+#ifndef _CP_EXTERNAL_SORT_INCLUDED_
+#define _CP_EXTERNAL_SORT_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <cstdio>
+#include <deque>
+#include <vector>
+#include <string>
+#include <memory>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <iterator>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include "loser_tree.h"
+#include "scratch_file.h"
+//#pragma once
+
+namespace CP
+{
+
+	// sorts more records than fit in memory
+	// push() fills a buffer of the memory budget; full buffers are sorted and
+	// written as run files by up to threads workers while the next buffer
+	// fills. finish() merges the runs with a loser tree, in several passes
+	// when there are more runs than the budget has read buffers for. Every
+	// run is read and written sequentially in blocks, with the next block
+	// transferred by a single I/O thread while the current one is used. The
+	// result is streamed through begin()/end() or written with write().
+	// T must be trivially copyable since it is written to disk byte for byte
+	template <typename T, typename Comp = std::less<T>>
+	class external_sort
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "external_sort needs a trivially copyable T");
+
+	protected:
+		struct run
+		{
+			std::string path;
+			size_t count;
+		};
+
+		// one long-lived thread doing the block reads and writes of every
+		// run, in the order they are asked for
+		class io_thread
+		{
+		protected:
+			std::mutex mLock;
+			std::condition_variable mWake;
+			std::deque<std::packaged_task<size_t()>> mTasks;
+			bool mStop;
+			std::thread mThread;
+
+			void loop()
+			{
+				for (;;)
+				{
+					std::packaged_task<size_t()> task;
+					{
+						std::unique_lock<std::mutex> lock(mLock);
+						mWake.wait(lock, [this]()
+								   { return mStop || !mTasks.empty(); });
+						if (mTasks.empty())
+							return;
+						task = std::move(mTasks.front());
+						mTasks.pop_front();
+					}
+					task();
+				}
+			}
+
+		public:
+			io_thread() : mStop(false), mThread(&io_thread::loop, this) {}
+
+			io_thread(const io_thread &) = delete;
+			io_thread &operator=(const io_thread &) = delete;
+
+			// finishes the transfers already asked for
+			~io_thread()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mLock);
+					mStop = true;
+				}
+				mWake.notify_one();
+				mThread.join();
+			}
+
+			template <typename F>
+			std::future<size_t> submit(F f)
+			{
+				std::packaged_task<size_t()> task(std::move(f));
+				std::future<size_t> result = task.get_future();
+				{
+					std::lock_guard<std::mutex> lock(mLock);
+					mTasks.push_back(std::move(task));
+				}
+				mWake.notify_one();
+				return result;
+			}
+		};
+
+		// reads a run front to back, prefetching one block ahead
+		class run_reader
+		{
+		protected:
+			io_thread &mIO;
+			std::string mPath;
+			FILE *mFile;
+			std::vector<T> mBuf[2];
+			size_t mCur; // buffer being consumed
+			size_t mPos;
+			size_t mLen;
+			size_t mRemaining; // elements not yet requested from the file
+			size_t mAsked;	   // size of the block in flight
+			bool mRemove;	   // delete the file when done
+			std::future<size_t> mNext;
+
+			void fetch()
+			{
+				size_t n = std::min(mRemaining, mBuf[0].size());
+				mRemaining -= n;
+				mAsked = n;
+				T *dst = mBuf[mCur ^ 1].data();
+				FILE *f = mFile;
+				mNext = mIO.submit([f, dst, n]()
+								   { return std::fread(dst, sizeof(T), n, f); });
+			}
+
+		public:
+			run_reader(io_thread &io, const std::string &path, size_t count, size_t block, bool remove)
+				: mIO(io), mPath(path), mCur(1), mPos(0), mLen(0), mRemaining(count), mAsked(0), mRemove(remove)
+			{
+				mFile = std::fopen(path.c_str(), "rb");
+				if (mFile == nullptr)
+					throw std::runtime_error("cannot open run " + path);
+				advise_sequential(mFile);
+				mBuf[0].resize(block);
+				mBuf[1].resize(block);
+				if (mRemaining > 0)
+					fetch();
+			}
+
+			run_reader(const run_reader &) = delete;
+			run_reader &operator=(const run_reader &) = delete;
+
+			~run_reader()
+			{
+				if (mNext.valid())
+					mNext.wait();
+				std::fclose(mFile);
+				if (mRemove)
+					std::remove(mPath.c_str());
+			}
+
+			bool next(T &out)
+			{
+				if (mPos == mLen)
+				{
+					if (!mNext.valid())
+						return false;
+					mLen = mNext.get();
+					mCur ^= 1;
+					mPos = 0;
+					if (mLen != mAsked)
+						throw std::runtime_error("cannot read run " + mPath);
+					if (mRemaining > 0)
+						fetch();
+				}
+				out = mBuf[mCur][mPos++];
+				return true;
+			}
+		};
+
+		// writes a run front to back, one block in flight while the next fills
+		class run_writer
+		{
+		protected:
+			io_thread &mIO;
+			std::string mPath;
+			FILE *mFile;
+			std::vector<T> mBuf[2];
+			size_t mCur;
+			size_t mLen;
+			std::future<size_t> mPending;
+
+			void flush()
+			{
+				if (mPending.valid())
+					mPending.get();
+				const T *src = mBuf[mCur].data();
+				size_t n = mLen;
+				FILE *f = mFile;
+				std::string path = mPath;
+				mPending = mIO.submit([f, src, n, path]()
+									  {
+										  if (std::fwrite(src, sizeof(T), n, f) != n)
+											  throw std::runtime_error("cannot write run " + path);
+										  return n; });
+				mCur ^= 1;
+				mLen = 0;
+			}
+
+		public:
+			run_writer(io_thread &io, const std::string &path, size_t block) : mIO(io), mPath(path), mCur(0), mLen(0)
+			{
+				mFile = std::fopen(path.c_str(), "wb");
+				if (mFile == nullptr)
+					throw std::runtime_error("cannot create run " + path);
+				mBuf[0].resize(block);
+				mBuf[1].resize(block);
+			}
+
+			run_writer(const run_writer &) = delete;
+			run_writer &operator=(const run_writer &) = delete;
+
+			~run_writer()
+			{
+				if (mPending.valid())
+					mPending.wait();
+				if (mFile != nullptr)
+					std::fclose(mFile);
+			}
+
+			void put(const T &v)
+			{
+				mBuf[mCur][mLen++] = v;
+				if (mLen == mBuf[mCur].size())
+					flush();
+			}
+
+			void close()
+			{
+				if (mLen > 0)
+					flush();
+				if (mPending.valid())
+					mPending.get();
+				if (std::fclose(mFile) != 0)
+				{
+					mFile = nullptr;
+					throw std::runtime_error("cannot write run " + mPath);
+				}
+				mFile = nullptr;
+			}
+		};
+
+		// k-way merge of run files
+		class merger
+		{
+		protected:
+			std::vector<std::unique_ptr<run_reader>> mReaders;
+			loser_tree<T, Comp> mTree;
+
+		public:
+			merger(io_thread &io, const std::vector<run> &runs, size_t block, const Comp &c) : mTree(runs.size(), c)
+			{
+				for (const run &r : runs)
+					mReaders.emplace_back(new run_reader(io, r.path, r.count, block, true));
+				T v;
+				for (size_t i = 0; i < mReaders.size(); i++)
+				{
+					if (mReaders[i]->next(v))
+						mTree.set(i, v);
+				}
+				mTree.build();
+			}
+
+			bool next(T &out)
+			{
+				if (mTree.empty())
+					return false;
+				size_t s = mTree.top_source();
+				out = mTree.top();
+				T v;
+				if (mReaders[s]->next(v))
+					mTree.replace_top(v);
+				else
+					mTree.pop_source();
+				return true;
+			}
+		};
+
+		std::string mDir;
+		size_t mThreads;
+		size_t mRunCap; // elements per in-memory run buffer
+		size_t mBlock;	// elements per I/O block
+		size_t mFanIn;	// runs merged at once
+		Comp mLess;
+		io_thread mIO; // outlives the readers and writers using it
+		std::vector<T> mBuffer;
+		std::vector<run> mRuns;
+		std::deque<std::future<void>> mPending; // run generation in flight
+		std::unique_ptr<merger> mMerge;
+		size_t mMemPos; // read position when nothing was spilled
+		size_t mSize;
+		bool mFinished;
+
+		std::string run_path()
+		{
+			return scratch_path(mDir, "run", ".run");
+		}
+
+		void wait_pending(size_t keep)
+		{
+			while (mPending.size() > keep)
+			{
+				std::future<void> f = std::move(mPending.front());
+				mPending.pop_front();
+				f.get();
+			}
+		}
+
+		// hands the full buffer to a worker that sorts it and writes a run
+		void spill()
+		{
+			if (mBuffer.empty())
+				return;
+			wait_pending(mThreads - 1);
+			run r;
+			r.path = run_path();
+			r.count = mBuffer.size();
+			mRuns.push_back(r);
+			Comp less = mLess;
+			mPending.push_back(std::async(std::launch::async, [buf = std::move(mBuffer), path = r.path, less]() mutable
+										  {
+											  std::sort(buf.begin(), buf.end(), less);
+											  FILE *f = std::fopen(path.c_str(), "wb");
+											  if (f == nullptr)
+												  throw std::runtime_error("cannot create run " + path);
+											  size_t n = std::fwrite(buf.data(), sizeof(T), buf.size(), f);
+											  if (std::fclose(f) != 0 || n != buf.size())
+												  throw std::runtime_error("cannot write run " + path); }));
+			// push() reserves the next buffer, so none is held after the last run
+			mBuffer = std::vector<T>();
+		}
+
+		// merges the oldest runs until one pass can take all of them
+		void reduce_runs()
+		{
+			while (mRuns.size() > mFanIn)
+			{
+				std::vector<run> group(mRuns.begin(), mRuns.begin() + mFanIn);
+				mRuns.erase(mRuns.begin(), mRuns.begin() + mFanIn);
+				run r;
+				r.path = run_path();
+				r.count = 0;
+				merger m(mIO, group, mBlock, mLess);
+				run_writer w(mIO, r.path, mBlock);
+				T v;
+				while (m.next(v))
+				{
+					w.put(v);
+					r.count++;
+				}
+				w.close();
+				mRuns.push_back(r);
+			}
+		}
+
+		bool next(T &out)
+		{
+			if (mMerge)
+				return mMerge->next(out);
+			if (mMemPos < mBuffer.size())
+			{
+				out = mBuffer[mMemPos++];
+				return true;
+			}
+			return false;
+		}
+
+		class sorted_iterator
+		{
+			friend class external_sort;
+
+		protected:
+			external_sort *mSort;
+			T mValue;
+
+			void advance()
+			{
+				if (mSort != nullptr && !mSort->next(mValue))
+					mSort = nullptr;
+			}
+
+		public:
+			typedef std::input_iterator_tag iterator_category;
+			typedef T value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const T *pointer;
+			typedef const T &reference;
+
+			sorted_iterator() : mSort(nullptr), mValue() {}
+
+			sorted_iterator(external_sort *s) : mSort(s), mValue()
+			{
+				advance();
+			}
+
+			sorted_iterator &operator++()
+			{
+				advance();
+				return (*this);
+			}
+
+			const T &operator*() const { return mValue; }
+			const T *operator->() const { return &mValue; }
+			bool operator==(const sorted_iterator &other) const { return mSort == other.mSort; }
+			bool operator!=(const sorted_iterator &other) const { return mSort != other.mSort; }
+		};
+
+	public:
+		typedef sorted_iterator iterator;
+
+		//-------------- constructor ----------
+
+		// memory is the budget in bytes for run buffers, and later for the
+		// read buffers of the merge; runs go to files in dir
+		external_sort(const std::string &dir, size_t memory = (size_t)1 << 30,
+					  size_t threads = std::thread::hardware_concurrency(), const Comp &c = Comp())
+			: mDir(dir), mThreads(std::max<size_t>(1, threads)), mLess(c), mMemPos(0), mSize(0),
+			  mFinished(false)
+		{
+			size_t total = std::max<size_t>(memory / sizeof(T), 64);
+			// threads buffers being sorted plus the one being filled
+			mRunCap = std::max<size_t>(total / (mThreads + 1), 1);
+			mBlock = std::max<size_t>(std::min<size_t>(((size_t)1 << 20) / sizeof(T), total / 64), 1);
+			// two blocks per input and two for the output
+			mFanIn = std::max<size_t>(total / (2 * mBlock), 4) - 2;
+			mBuffer.reserve(mRunCap);
+		}
+
+		external_sort(const external_sort &) = delete;
+		external_sort &operator=(const external_sort &) = delete;
+
+		~external_sort()
+		{
+			for (auto &f : mPending)
+			{
+				if (f.valid())
+					f.wait();
+			}
+			mMerge.reset();
+			for (const run &r : mRuns)
+				std::remove(r.path.c_str());
+		}
+
+		//------------- capacity function -------------------
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		// number of run files written so far
+		size_t runs() const
+		{
+			return mRuns.size();
+		}
+
+		//----------------- modifier -------------
+		void push(const T &element)
+		{
+			if (mFinished)
+				throw std::logic_error("external_sort already finished");
+			if (mBuffer.empty())
+				mBuffer.reserve(mRunCap);
+			mBuffer.push_back(element);
+			mSize++;
+			if (mBuffer.size() >= mRunCap)
+				spill();
+		}
+
+		template <typename InputIt>
+		void push_range(InputIt first, InputIt last)
+		{
+			for (; first != last; ++first)
+				push(*first);
+		}
+
+		// ends the input; when nothing was spilled the data is sorted in memory
+		void finish()
+		{
+			if (mFinished)
+				return;
+			mFinished = true;
+			if (mRuns.empty())
+			{
+				std::sort(mBuffer.begin(), mBuffer.end(), mLess);
+				return;
+			}
+			spill();
+			wait_pending(0);
+			reduce_runs();
+			mMerge.reset(new merger(mIO, mRuns, mBlock, mLess));
+			// the merger owns the files now and deletes them as it finishes
+			mRuns.clear();
+		}
+
+		//----------------- iterator ---------------
+		// the sorted sequence can be streamed once
+		iterator begin()
+		{
+			finish();
+			return iterator(this);
+		}
+
+		iterator end()
+		{
+			return iterator();
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		// streams the sorted sequence into a file
+		void write(const std::string &path)
+		{
+			run_writer w(mIO, path, mBlock);
+			for (iterator it = begin(); it != end(); ++it)
+				w.put(*it);
+			w.close();
+		}
+
+		// sorts the records of one file into another
+		static void sort_file(const std::string &in, const std::string &out, const std::string &dir,
+							  size_t memory = (size_t)1 << 30, size_t threads = std::thread::hardware_concurrency(),
+							  const Comp &c = Comp())
+		{
+			FILE *f = std::fopen(in.c_str(), "rb");
+			if (f == nullptr)
+				throw std::runtime_error("cannot open " + in);
+			std::fseek(f, 0, SEEK_END);
+			long bytes = std::ftell(f);
+			std::fclose(f);
+			external_sort s(dir, memory, threads, c);
+			{
+				run_reader r(s.mIO, in, (size_t)bytes / sizeof(T), s.mBlock, false);
+				T v;
+				while (r.next(v))
+					s.push(v);
+			}
+			s.write(out);
+		}
+	};
+}
+
+#endif
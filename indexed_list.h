@@ -0,0 +1,656 @@
+#ifndef _CP_INDEXED_LIST_INCLUDED_
+#define _CP_INDEXED_LIST_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <cstdint>
+//#pragma once
+
+namespace CP
+{
+
+	// doubly linked list with positional access
+	// the nodes are linked exactly as in CP::list, and the same nodes also
+	// form an implicit treap (a randomized balanced tree keyed by position)
+	// whose subtrees know their size. Iteration follows the links; at(i),
+	// index_of(it), insert/erase, split at a position and rotation go through
+	// the tree in O(log n) expected. Bulk filters relink in one pass and
+	// rebuild the tree in O(n)
+	template <typename T>
+	class indexed_list
+	{
+	protected:
+		class node
+		{
+			friend class indexed_list;
+
+		public:
+			T data;
+			node *prev;
+			node *next;
+
+		protected:
+			node *left;
+			node *right;
+			node *parent;
+			unsigned prio;
+			size_t cnt; // nodes in this subtree
+
+		public:
+			node() : data(T()), prev(this), next(this), left(nullptr), right(nullptr), parent(nullptr), prio(0), cnt(1) {}
+
+			node(const T &data, unsigned prio) : data(data), prev(this), next(this), left(nullptr), right(nullptr),
+												 parent(nullptr), prio(prio), cnt(1) {}
+		};
+
+		class list_iterator
+		{
+			friend class indexed_list;
+
+		protected:
+			node *ptr;
+
+		public:
+			list_iterator() : ptr(nullptr) {}
+
+			list_iterator(node *a) : ptr(a) {}
+
+			list_iterator &operator++()
+			{
+				ptr = ptr->next;
+				return (*this);
+			}
+
+			list_iterator &operator--()
+			{
+				ptr = ptr->prev;
+				return (*this);
+			}
+
+			list_iterator operator++(int)
+			{
+				list_iterator tmp(*this);
+				operator++();
+				return tmp;
+			}
+
+			list_iterator operator--(int)
+			{
+				list_iterator tmp(*this);
+				operator--();
+				return tmp;
+			}
+
+			T &operator*() { return ptr->data; }
+			T *operator->() { return &(ptr->data); }
+			bool operator==(const list_iterator &other) { return other.ptr == ptr; }
+			bool operator!=(const list_iterator &other) { return other.ptr != ptr; }
+		};
+
+	public:
+		typedef list_iterator iterator;
+
+	protected:
+		node *mHeader; // pointer to a header node, not part of the tree
+		node *mRoot;
+		size_t mSize;
+		unsigned mSeed;
+
+		// lists joined by append/merge must not share a priority sequence,
+		// so each one starts from its own seed
+		static unsigned fresh_seed(const void *self)
+		{
+			static std::atomic<unsigned long long> counter(0);
+			unsigned long long x = (counter.fetch_add(1) + 1) * 0x9e3779b97f4a7c15ull ^ (unsigned long long)(uintptr_t)self;
+			x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+			x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+			x ^= x >> 31;
+			unsigned s = (unsigned)(x ^ (x >> 32));
+			return s != 0 ? s : 2463534242u; // xorshift32 must not start at 0
+		}
+
+		unsigned next_prio()
+		{
+			// xorshift32
+			mSeed ^= mSeed << 13;
+			mSeed ^= mSeed >> 17;
+			mSeed ^= mSeed << 5;
+			return mSeed;
+		}
+
+		//---------- tree ----------
+		static size_t count(node *n)
+		{
+			return n == nullptr ? 0 : n->cnt;
+		}
+
+		static void pull(node *n)
+		{
+			n->cnt = 1 + count(n->left) + count(n->right);
+			if (n->left != nullptr)
+				n->left->parent = n;
+			if (n->right != nullptr)
+				n->right->parent = n;
+		}
+
+		static node *join(node *a, node *b)
+		{
+			if (a == nullptr)
+				return b;
+			if (b == nullptr)
+				return a;
+			if (a->prio > b->prio)
+			{
+				a->right = join(a->right, b);
+				pull(a);
+				return a;
+			}
+			b->left = join(a, b->left);
+			pull(b);
+			return b;
+		}
+
+		// the first k nodes of t go to a, the rest to b
+		static void cut(node *t, size_t k, node *&a, node *&b)
+		{
+			if (t == nullptr)
+			{
+				a = b = nullptr;
+				return;
+			}
+			if (count(t->left) < k)
+			{
+				cut(t->right, k - count(t->left) - 1, t->right, b);
+				pull(t);
+				a = t;
+			}
+			else
+			{
+				cut(t->left, k, a, t->left);
+				pull(t);
+				b = t;
+			}
+		}
+
+		void set_root(node *r)
+		{
+			mRoot = r;
+			if (r != nullptr)
+				r->parent = nullptr;
+		}
+
+		node *node_at(size_t i) const
+		{
+			node *n = mRoot;
+			while (true)
+			{
+				size_t l = count(n->left);
+				if (i == l)
+					return n;
+				if (i < l)
+					n = n->left;
+				else
+				{
+					i -= l + 1;
+					n = n->right;
+				}
+			}
+		}
+
+		size_t position(node *n) const
+		{
+			if (n == mHeader)
+				return mSize;
+			size_t i = count(n->left);
+			while (n->parent != nullptr)
+			{
+				if (n == n->parent->right)
+					i += count(n->parent->left) + 1;
+				n = n->parent;
+			}
+			return i;
+		}
+
+		void tree_insert(size_t k, node *n)
+		{
+			n->left = n->right = n->parent = nullptr;
+			n->cnt = 1;
+			node *a, *b;
+			cut(mRoot, k, a, b);
+			set_root(join(join(a, n), b));
+		}
+
+		void tree_remove(node *n)
+		{
+			node *c = join(n->left, n->right);
+			node *p = n->parent;
+			if (c != nullptr)
+				c->parent = p;
+			if (p == nullptr)
+				mRoot = c;
+			else if (p->left == n)
+				p->left = c;
+			else
+				p->right = c;
+			for (; p != nullptr; p = p->parent)
+				p->cnt--;
+		}
+
+		// builds the treap over the linked order in O(n)
+		void rebuild()
+		{
+			std::vector<node *> st;
+			for (node *n = mHeader->next; n != mHeader; n = n->next)
+			{
+				n->left = n->right = nullptr;
+				node *last = nullptr;
+				while (!st.empty() && st.back()->prio < n->prio)
+				{
+					last = st.back();
+					st.pop_back();
+					pull(last);
+				}
+				n->left = last;
+				if (!st.empty())
+					st.back()->right = n;
+				st.push_back(n);
+			}
+			while (st.size() > 1)
+			{
+				pull(st.back());
+				st.pop_back();
+			}
+			if (st.empty())
+				set_root(nullptr);
+			else
+			{
+				pull(st[0]);
+				set_root(st[0]);
+			}
+		}
+
+		//---------- links ----------
+		static void link_before(node *n, node *before)
+		{
+			n->prev = before->prev;
+			n->next = before;
+			before->prev->next = n;
+			before->prev = n;
+		}
+
+		static void unlink(node *n)
+		{
+			n->prev->next = n->next;
+			n->next->prev = n->prev;
+		}
+
+		// moves the nodes first..last (inclusive) in front of before
+		static void splice_nodes(node *first, node *last, node *before)
+		{
+			first->prev->next = last->next;
+			last->next->prev = first->prev;
+			first->prev = before->prev;
+			last->next = before;
+			before->prev->next = first;
+			before->prev = last;
+		}
+
+		void rangeCheck(size_t i) const
+		{
+			if (i >= mSize)
+				throw std::out_of_range("index of out range");
+		}
+
+	public:
+		//-------------- constructor & copy operator ----------
+
+		// copy constructor
+		indexed_list(const indexed_list<T> &a) : indexed_list()
+		{
+			for (node *n = a.mHeader->next; n != a.mHeader; n = n->next)
+			{
+				node *m = new node(n->data, next_prio());
+				link_before(m, mHeader);
+				mSize++;
+			}
+			rebuild();
+		}
+
+		// default constructor
+		indexed_list() : mHeader(new node()), mRoot(nullptr), mSize(0), mSeed(fresh_seed(this)) {}
+
+		// copy assignment operator using copy-and-swap idiom
+		indexed_list<T> &operator=(indexed_list<T> other)
+		{
+			using std::swap;
+			swap(this->mHeader, other.mHeader);
+			swap(this->mRoot, other.mRoot);
+			swap(this->mSize, other.mSize);
+			swap(this->mSeed, other.mSeed);
+			return *this;
+		}
+
+		~indexed_list()
+		{
+			clear();
+			delete mHeader;
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		//----------------- iterator ---------------
+		iterator begin()
+		{
+			return iterator(mHeader->next);
+		}
+
+		iterator end()
+		{
+			return iterator(mHeader);
+		}
+
+		//----------------- access -----------------
+		T &front() { return mHeader->next->data; }
+
+		T &back() { return mHeader->prev->data; }
+
+		// O(log n)
+		T &at(size_t i)
+		{
+			rangeCheck(i);
+			return node_at(i)->data;
+		}
+
+		T &operator[](size_t i)
+		{
+			return node_at(i)->data;
+		}
+
+		// O(log n), end() for i == size()
+		iterator iterator_at(size_t i)
+		{
+			if (i == mSize)
+				return end();
+			rangeCheck(i);
+			return iterator(node_at(i));
+		}
+
+		// O(log n), size() for end()
+		size_t index_of(iterator it) const
+		{
+			return position(it.ptr);
+		}
+
+		//----------------- modifier -------------
+		void push_back(const T &element)
+		{
+			insert(end(), element);
+		}
+
+		void push_front(const T &element)
+		{
+			insert(begin(), element);
+		}
+
+		void pop_back()
+		{
+			erase(iterator(mHeader->prev));
+		}
+
+		void pop_front()
+		{
+			erase(begin());
+		}
+
+		iterator insert(iterator it, const T &element)
+		{
+			node *n = new node(element, next_prio());
+			tree_insert(position(it.ptr), n);
+			link_before(n, it.ptr);
+			mSize++;
+			return iterator(n);
+		}
+
+		iterator erase(iterator it)
+		{
+			iterator tmp(it.ptr->next);
+			tree_remove(it.ptr);
+			unlink(it.ptr);
+			delete it.ptr;
+			mSize--;
+			return tmp;
+		}
+
+		void clear()
+		{
+			node *n = mHeader->next;
+			while (n != mHeader)
+			{
+				node *next = n->next;
+				delete n;
+				n = next;
+			}
+			mHeader->next = mHeader->prev = mHeader;
+			mRoot = nullptr;
+			mSize = 0;
+		}
+
+		void print()
+		{
+			std::cout << " Size = " << mSize << std::endl;
+			int i = 0;
+			for (iterator it = begin(); it != end(); it++, i++)
+			{
+				std::cout << "Node " << i << ": " << *it << std::endl;
+			}
+		}
+
+		// depth of the treap, -1 when empty; expected O(log n)
+		int height() const
+		{
+			int h = -1;
+			std::vector<std::pair<node *, int>> st;
+			if (mRoot != nullptr)
+				st.push_back(std::make_pair(mRoot, 0));
+			while (!st.empty())
+			{
+				std::pair<node *, int> top = st.back();
+				st.pop_back();
+				if (top.second > h)
+					h = top.second;
+				if (top.first->left != nullptr)
+					st.push_back(std::make_pair(top.first->left, top.second + 1));
+				if (top.first->right != nullptr)
+					st.push_back(std::make_pair(top.first->right, top.second + 1));
+			}
+			return h;
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		// moves the elements at the increasing indices in selected, in that
+		// order, in front of the element at pos; O(|selected| log n)
+		void reorder(int pos, std::vector<int> selected)
+		{
+			node *before = (size_t)pos >= mSize ? mHeader : node_at(pos);
+			std::vector<node *> moved;
+			moved.reserve(selected.size());
+			for (int x : selected)
+				moved.push_back(node_at(x));
+			for (node *n : moved)
+			{
+				if (n == before)
+					continue;
+				tree_remove(n);
+				unlink(n);
+				tree_insert(position(before), n);
+				link_before(n, before);
+			}
+		}
+
+		// moves every element equal to value in [a, b) to the front of output
+		void extract(const T &value, iterator a, iterator b, CP::indexed_list<T> &output)
+		{
+			if (&output == this)
+				return;
+			node *n = a.ptr;
+			bool moved = false;
+			while (n != b.ptr)
+			{
+				node *next = n->next;
+				if (n->data == value)
+				{
+					unlink(n);
+					link_before(n, output.mHeader->next);
+					mSize--;
+					output.mSize++;
+					moved = true;
+				}
+				n = next;
+			}
+			if (moved)
+			{
+				rebuild();
+				output.rebuild();
+			}
+		}
+
+		iterator reverse(iterator a, iterator b)
+		{
+			if (mSize == 0 || a == b)
+				return a;
+			auto ait = a, bit = b;
+			--bit;
+			while (ait != bit)
+			{
+				std::swap(*ait, *bit);
+				++ait;
+				if (ait == bit)
+					break;
+				--bit;
+			}
+			return a;
+		}
+
+		void shift_left()
+		{
+			shift(1);
+		}
+
+		// first (size + 1) / 2 elements to the end of list1, the rest to list2
+		void splitList(CP::indexed_list<T> &list1, CP::indexed_list<T> &list2)
+		{
+			if (mSize == 0)
+				return;
+			size_t n = (mSize + 1) / 2;
+			indexed_list<T> tail = split_at(n);
+			list1.append(*this);
+			list2.append(tail);
+		}
+
+		// the matches are unlinked in one pass and deleted afterwards, since
+		// value may be one of them
+		void remove_all(const T &value)
+		{
+			node *victims = nullptr;
+			node *n = mHeader->next;
+			while (n != mHeader)
+			{
+				node *next = n->next;
+				if (n->data == value)
+				{
+					unlink(n);
+					n->next = victims;
+					victims = n;
+					mSize--;
+				}
+				n = next;
+			}
+			if (victims == nullptr)
+				return;
+			while (victims != nullptr)
+			{
+				node *next = victims->next;
+				delete victims;
+				victims = next;
+			}
+			rebuild();
+		}
+
+		// elements from position pos to the end move to the result, O(log n)
+		CP::indexed_list<T> split_at(size_t pos)
+		{
+			CP::indexed_list<T> result;
+			if (pos >= mSize)
+				return result;
+			node *first = node_at(pos);
+			node *a, *b;
+			cut(mRoot, pos, a, b);
+			set_root(a);
+			result.set_root(b);
+			splice_nodes(first, mHeader->prev, result.mHeader);
+			result.mSize = mSize - pos;
+			mSize = pos;
+			return result;
+		}
+
+		// elements from it to the end move to the result, O(log n)
+		CP::indexed_list<T> split(iterator it)
+		{
+			return split_at(position(it.ptr));
+		}
+
+		// rotates left by k: element k becomes the front, O(log n)
+		void shift(long long k)
+		{
+			if (mSize == 0)
+				return;
+			long long s = (long long)mSize;
+			k %= s;
+			if (k < 0)
+				k += s;
+			if (k == 0)
+				return;
+			node *first = node_at((size_t)k);
+			node *a, *b;
+			cut(mRoot, (size_t)k, a, b);
+			set_root(join(b, a));
+			// the header moves in front of first
+			unlink(mHeader);
+			link_before(mHeader, first);
+		}
+
+		// moves every element of other to the end of this list, O(log n)
+		void append(CP::indexed_list<T> &other)
+		{
+			if (&other == this || other.mSize == 0)
+				return;
+			splice_nodes(other.mHeader->next, other.mHeader->prev, mHeader);
+			set_root(join(mRoot, other.mRoot));
+			mSize += other.mSize;
+			other.mRoot = nullptr;
+			other.mSize = 0;
+		}
+
+		// moves every element of each list in ls to the end of this list
+		template <typename ListOfLists>
+		void merge(ListOfLists &ls)
+		{
+			for (auto &x : ls)
+				append(x);
+		}
+	};
+}
+
+#endif
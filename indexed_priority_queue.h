@@ -0,0 +1,219 @@
+#ifndef _CP_INDEXED_PRIORITY_QUEUE_INCLUDED_
+#define _CP_INDEXED_PRIORITY_QUEUE_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <cstdint>
+//#pragma once
+
+namespace CP
+{
+
+	// addressable d-ary heap
+	// push() returns a stable handle; the heap stores slot indices and mPos
+	// maps a slot to its current position, kept up to date by fixUp/fixDown,
+	// so update/erase/contains never search. A slot is recycled once its
+	// element has been popped or erased; the handle carries the slot's
+	// generation, so a stale handle is rejected instead of reaching the
+	// element that reused the slot
+	template <typename T, typename Comp = std::less<T>, size_t Arity = 2>
+	class indexed_priority_queue
+	{
+		static_assert(Arity >= 2, "indexed_priority_queue needs at least two children per node");
+
+	public:
+		struct handle
+		{
+			size_t index;
+			uint32_t generation;
+		};
+		static constexpr size_t npos = (size_t)-1;
+
+	protected:
+		std::vector<size_t> mHeap;	 // heap of slots
+		std::vector<size_t> mPos;	 // slot -> position in mHeap, npos if free
+		std::vector<uint32_t> mGen; // slot -> generation, bumped when freed
+		std::vector<T> mValue;		 // slot -> value
+		std::vector<size_t> mFree;	 // recycled slots
+		Comp mLess;
+
+		void place(size_t idx, size_t h)
+		{
+			mHeap[idx] = h;
+			mPos[h] = idx;
+		}
+
+		void fixUp(size_t idx)
+		{
+			size_t h = mHeap[idx];
+			while (idx > 0)
+			{
+				size_t p = (idx - 1) / Arity;
+				if (mLess(mValue[h], mValue[mHeap[p]]))
+					break;
+				place(idx, mHeap[p]);
+				idx = p;
+			}
+			place(idx, h);
+		}
+
+		void fixDown(size_t idx)
+		{
+			size_t h = mHeap[idx];
+			size_t n = mHeap.size();
+			size_t c;
+			while ((c = Arity * idx + 1) < n)
+			{
+				size_t end = c + Arity < n ? c + Arity : n;
+				size_t b = c;
+				for (size_t i = c + 1; i < end; i++)
+				{
+					if (mLess(mValue[mHeap[b]], mValue[mHeap[i]]))
+						b = i;
+				}
+				if (mLess(mValue[mHeap[b]], mValue[h]))
+					break;
+				place(idx, mHeap[b]);
+				idx = b;
+			}
+			place(idx, h);
+		}
+
+		void checkHandle(handle h) const
+		{
+			if (!contains(h))
+				throw std::out_of_range("invalid handle");
+		}
+
+		void remove_at(size_t idx)
+		{
+			size_t h = mHeap[idx];
+			size_t last = mHeap.back();
+			mHeap.pop_back();
+			mPos[h] = npos;
+			mGen[h]++;
+			mFree.push_back(h);
+			if (idx < mHeap.size())
+			{
+				place(idx, last);
+				fixUp(idx);
+				fixDown(mPos[last]);
+			}
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// default constructor
+		indexed_priority_queue(const Comp &c = Comp()) : mLess(c) {}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mHeap.empty();
+		}
+
+		size_t size() const
+		{
+			return mHeap.size();
+		}
+
+		void reserve(size_t n)
+		{
+			mHeap.reserve(n);
+			mPos.reserve(n);
+			mGen.reserve(n);
+			mValue.reserve(n);
+		}
+
+		//----------------- access -----------------
+		const T &top() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mValue[mHeap[0]];
+		}
+
+		handle top_handle() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return handle{mHeap[0], mGen[mHeap[0]]};
+		}
+
+		const T &value(handle h) const
+		{
+			checkHandle(h);
+			return mValue[h.index];
+		}
+
+		bool contains(handle h) const
+		{
+			return h.index < mPos.size() && mGen[h.index] == h.generation && mPos[h.index] != npos;
+		}
+
+		//----------------- modifier -------------
+		handle push(const T &element)
+		{
+			size_t h;
+			if (!mFree.empty())
+			{
+				h = mFree.back();
+				mFree.pop_back();
+				mValue[h] = element;
+			}
+			else
+			{
+				h = mValue.size();
+				mValue.push_back(element);
+				mPos.push_back(npos);
+				mGen.push_back(0);
+			}
+			mHeap.push_back(h);
+			mPos[h] = mHeap.size() - 1;
+			fixUp(mHeap.size() - 1);
+			return handle{h, mGen[h]};
+		}
+
+		void pop()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			remove_at(0);
+		}
+
+		// O(log n), works for both decrease-key and increase-key
+		void update(handle h, const T &v)
+		{
+			checkHandle(h);
+			mValue[h.index] = v;
+			size_t idx = mPos[h.index];
+			fixUp(idx);
+			fixDown(mPos[h.index]);
+		}
+
+		// O(log n)
+		void erase(handle h)
+		{
+			checkHandle(h);
+			remove_at(mPos[h.index]);
+		}
+
+		// the slots are kept and their generations bumped, so handles given
+		// out before stay invalid
+		void clear()
+		{
+			for (size_t h : mHeap)
+			{
+				mPos[h] = npos;
+				mGen[h]++;
+				mFree.push_back(h);
+			}
+			mHeap.clear();
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,364 @@
+#ifndef _CP_INTRUSIVE_LIST_INCLUDED_
+#define _CP_INTRUSIVE_LIST_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <cstddef>
+#include <utility>
+#include <atomic>
+//#pragma once
+
+namespace CP
+{
+
+	// links embedded in an element of an intrusive_list
+	// copying an element does not copy its links: the copy starts unlinked
+	class list_hook
+	{
+	public:
+		list_hook *prev;
+		list_hook *next;
+
+		list_hook() : prev(nullptr), next(nullptr) {}
+
+		list_hook(const list_hook &) : prev(nullptr), next(nullptr) {}
+
+		list_hook &operator=(const list_hook &) { return *this; }
+
+		bool is_linked() const
+		{
+			return next != nullptr;
+		}
+	};
+
+	// doubly linked list over objects the caller owns
+	// T embeds one list_hook per list it can be in and Hook names the one
+	// this list uses, e.g. intrusive_list<job, &job::ready_hook>. Nothing is
+	// allocated or copied: push links the object itself, erase(obj) unlinks
+	// it in O(1) without a search, and splicing only relinks. An object must
+	// stay alive while it is linked and can be in one list per hook
+	template <typename T, list_hook T::*Hook>
+	class intrusive_list
+	{
+	protected:
+		static list_hook *hook_of(T &obj)
+		{
+			return &(obj.*Hook);
+		}
+
+		// offset of the hook inside T, taken from the live object every
+		// insert links, so it is known before any hook is turned back into
+		// its owner
+		static std::atomic<size_t> &hook_offset_slot()
+		{
+			static std::atomic<size_t> offset(0);
+			return offset;
+		}
+
+		static void record_offset(T &obj)
+		{
+			size_t offset = (size_t)(reinterpret_cast<char *>(hook_of(obj)) - reinterpret_cast<char *>(&obj));
+			hook_offset_slot().store(offset, std::memory_order_relaxed);
+		}
+
+		static size_t hook_offset()
+		{
+			return hook_offset_slot().load(std::memory_order_relaxed);
+		}
+
+		static T *owner_of(list_hook *h)
+		{
+			return reinterpret_cast<T *>(reinterpret_cast<char *>(h) - hook_offset());
+		}
+
+		class list_iterator
+		{
+			friend class intrusive_list;
+
+		protected:
+			list_hook *ptr;
+
+		public:
+			list_iterator() : ptr(nullptr) {}
+
+			list_iterator(list_hook *a) : ptr(a) {}
+
+			list_iterator &operator++()
+			{
+				ptr = ptr->next;
+				return (*this);
+			}
+
+			list_iterator &operator--()
+			{
+				ptr = ptr->prev;
+				return (*this);
+			}
+
+			list_iterator operator++(int)
+			{
+				list_iterator tmp(*this);
+				operator++();
+				return tmp;
+			}
+
+			list_iterator operator--(int)
+			{
+				list_iterator tmp(*this);
+				operator--();
+				return tmp;
+			}
+
+			T &operator*() { return *owner_of(ptr); }
+			T *operator->() { return owner_of(ptr); }
+			bool operator==(const list_iterator &other) { return other.ptr == ptr; }
+			bool operator!=(const list_iterator &other) { return other.ptr != ptr; }
+		};
+
+	public:
+		typedef list_iterator iterator;
+
+	protected:
+		list_hook mHeader;
+		size_t mSize;
+
+		static void link_before(list_hook *n, list_hook *before)
+		{
+			n->prev = before->prev;
+			n->next = before;
+			before->prev->next = n;
+			before->prev = n;
+		}
+
+		static void unlink(list_hook *n)
+		{
+			n->prev->next = n->next;
+			n->next->prev = n->prev;
+			n->prev = n->next = nullptr;
+		}
+
+		// moves the hooks first..last (inclusive) in front of before
+		static void splice_hooks(list_hook *first, list_hook *last, list_hook *before)
+		{
+			first->prev->next = last->next;
+			last->next->prev = first->prev;
+			first->prev = before->prev;
+			last->next = before;
+			before->prev->next = first;
+			before->prev = last;
+		}
+
+		void reset()
+		{
+			mHeader.prev = mHeader.next = &mHeader;
+			mSize = 0;
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// default constructor
+		intrusive_list()
+		{
+			reset();
+		}
+
+		// the header is linked into the elements, so a list is never copied
+		intrusive_list(const intrusive_list<T, Hook> &) = delete;
+		intrusive_list<T, Hook> &operator=(const intrusive_list<T, Hook> &) = delete;
+
+		~intrusive_list()
+		{
+			clear();
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		//----------------- iterator ---------------
+		iterator begin()
+		{
+			return iterator(mHeader.next);
+		}
+
+		iterator end()
+		{
+			return iterator(&mHeader);
+		}
+
+		// O(1), obj must be in this list
+		iterator iterator_to(T &obj)
+		{
+			return iterator(hook_of(obj));
+		}
+
+		//----------------- access -----------------
+		T &front() { return *owner_of(mHeader.next); }
+
+		T &back() { return *owner_of(mHeader.prev); }
+
+		//----------------- modifier -------------
+		void push_back(T &obj)
+		{
+			insert(end(), obj);
+		}
+
+		void push_front(T &obj)
+		{
+			insert(begin(), obj);
+		}
+
+		void pop_back()
+		{
+			erase(iterator(mHeader.prev));
+		}
+
+		void pop_front()
+		{
+			erase(begin());
+		}
+
+		iterator insert(iterator it, T &obj)
+		{
+			list_hook *h = hook_of(obj);
+			if (h->is_linked())
+				throw std::invalid_argument("object is already in a list through this hook");
+			record_offset(obj);
+			link_before(h, it.ptr);
+			mSize++;
+			return iterator(h);
+		}
+
+		iterator erase(iterator it)
+		{
+			iterator tmp(it.ptr->next);
+			unlink(it.ptr);
+			mSize--;
+			return tmp;
+		}
+
+		// O(1), obj must be in this list
+		void erase(T &obj)
+		{
+			erase(iterator_to(obj));
+		}
+
+		// unlinks every element, the objects themselves are untouched
+		void clear()
+		{
+			list_hook *n = mHeader.next;
+			while (n != &mHeader)
+			{
+				list_hook *next = n->next;
+				n->prev = n->next = nullptr;
+				n = next;
+			}
+			reset();
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		// reverses [a, b) by relinking, returns the new first element
+		iterator reverse(iterator a, iterator b)
+		{
+			if (mSize == 0 || a == b)
+				return a;
+			list_hook *before = a.ptr->prev;
+			list_hook *after = b.ptr;
+			list_hook *last = after->prev;
+			for (list_hook *n = a.ptr; n != after;)
+			{
+				list_hook *next = n->next;
+				std::swap(n->prev, n->next);
+				n = next;
+			}
+			before->next = last;
+			last->prev = before;
+			a.ptr->next = after;
+			after->prev = a.ptr;
+			return iterator(last);
+		}
+
+		void shift_left()
+		{
+			shift(1);
+		}
+
+		// rotates left by k: element k becomes the front
+		void shift(long long k)
+		{
+			if (mSize == 0)
+				return;
+			long long s = (long long)mSize;
+			k %= s;
+			if (k < 0)
+				k += s;
+			if (k == 0)
+				return;
+			list_hook *n = mHeader.next;
+			for (long long i = 0; i < k; ++i)
+				n = n->next;
+			// the header moves in front of n
+			mHeader.prev->next = mHeader.next;
+			mHeader.next->prev = mHeader.prev;
+			mHeader.next = n;
+			mHeader.prev = n->prev;
+			n->prev->next = &mHeader;
+			n->prev = &mHeader;
+		}
+
+		// first (size + 1) / 2 elements to the end of list1, the rest to list2
+		void splitList(CP::intrusive_list<T, Hook> &list1, CP::intrusive_list<T, Hook> &list2)
+		{
+			if (mSize == 0)
+				return;
+			size_t n = (mSize + 1) / 2;
+			list_hook *cut = mHeader.next;
+			for (size_t i = 0; i < n; ++i)
+				cut = cut->next;
+			if (cut != &mHeader)
+				splice_hooks(cut, mHeader.prev, &list2.mHeader);
+			splice_hooks(mHeader.next, mHeader.prev, &list1.mHeader);
+			list1.mSize += n;
+			list2.mSize += mSize - n;
+			mSize = 0;
+		}
+
+		// moves the elements from it (at index pos) to the end of result
+		void split(iterator it, size_t pos, CP::intrusive_list<T, Hook> &result)
+		{
+			if (it == end())
+				return;
+			splice_hooks(it.ptr, mHeader.prev, &result.mHeader);
+			result.mSize += mSize - pos;
+			mSize = pos;
+		}
+
+		// moves every element of other to the end of this list
+		void append(CP::intrusive_list<T, Hook> &other)
+		{
+			if (&other == this || other.mSize == 0)
+				return;
+			splice_hooks(other.mHeader.next, other.mHeader.prev, &mHeader);
+			mSize += other.mSize;
+			other.reset();
+		}
+
+		// moves every element of each list in ls to the end of this list
+		template <typename ListOfLists>
+		void merge(ListOfLists &ls)
+		{
+			for (auto &x : ls)
+				append(x);
+		}
+	};
+}
+
+#endif
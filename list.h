@@ -3,6 +3,10 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <vector>
+#include <thread>
+#include <functional>
+#include "node_pool.h"
 //#pragma once
 
 namespace CP
@@ -75,21 +79,137 @@ namespace CP
 	protected:
 		node *mHeader; // pointer to a header node
 		size_t mSize;
+		node_pool *mPool; // where the element nodes come from, nullptr for new/delete
+
+		node *new_node(const T &element, node *prev, node *next)
+		{
+			return pooled_nodes<node>::create(mPool, element, prev, next);
+		}
+
+		void free_node(node *n)
+		{
+			pooled_nodes<node>::destroy(mPool, n);
+		}
+
+		// nodes may only move between lists that take them from the same place
+		void check_pool(const list<T> &other) const
+		{
+			if (other.mPool != mPool)
+				throw std::invalid_argument("lists do not share a node pool");
+		}
+
+		// moves the nodes first..last (inclusive) in front of before
+		static void splice_nodes(node *first, node *last, node *before)
+		{
+			first->prev->next = last->next;
+			last->next->prev = first->prev;
+			first->prev = before->prev;
+			last->next = before;
+			before->prev->next = first;
+			before->prev = last;
+		}
+
+		// the sort helpers work on chains linked by next alone and ending in
+		// nullptr; relink() restores prev and the header afterwards
+		template <typename Comp>
+		static node *merge_chains(node *a, node *b, Comp &comp)
+		{
+			node *head = nullptr;
+			node **tail = &head;
+			while (a != nullptr && b != nullptr)
+			{
+				// ties are taken from a, which keeps the merge stable
+				if (comp(b->data, a->data))
+				{
+					*tail = b;
+					b = b->next;
+				}
+				else
+				{
+					*tail = a;
+					a = a->next;
+				}
+				tail = &(*tail)->next;
+			}
+			*tail = (a != nullptr ? a : b);
+			return head;
+		}
+
+		// bottom-up merge sort, bins[i] holds a sorted chain of 2^i nodes
+		template <typename Comp>
+		static node *sort_chain(node *head, Comp &comp)
+		{
+			node *bins[64] = {};
+			size_t used = 0;
+			while (head != nullptr)
+			{
+				node *carry = head;
+				head = head->next;
+				carry->next = nullptr;
+				size_t i = 0;
+				for (; bins[i] != nullptr; ++i)
+				{
+					carry = merge_chains(bins[i], carry, comp);
+					bins[i] = nullptr;
+				}
+				bins[i] = carry;
+				if (i >= used)
+					used = i + 1;
+			}
+			node *result = nullptr;
+			for (size_t i = 0; i < used; ++i)
+				if (bins[i] != nullptr)
+					result = merge_chains(bins[i], result, comp);
+			return result;
+		}
+
+		// makes the chain starting at head the content of this list
+		void relink(node *head)
+		{
+			node *prev = mHeader;
+			for (node *n = head; n != nullptr; n = n->next)
+			{
+				n->prev = prev;
+				prev->next = n;
+				prev = n;
+			}
+			prev->next = mHeader;
+			mHeader->prev = prev;
+		}
+
+		// detaches the content of this list as a chain
+		node *unlink_chain()
+		{
+			if (mSize == 0)
+				return nullptr;
+			node *head = mHeader->next;
+			mHeader->prev->next = nullptr;
+			mHeader->next = mHeader->prev = mHeader;
+			return head;
+		}
 
 	public:
 		//-------------- constructor & copy operator ----------
 
 		// copy constructor
-		list(list<T> &a) : mHeader(new node()), mSize(0)
+		list(list<T> &a) : mHeader(new node()), mSize(0), mPool(a.mPool)
 		{
+			if (mPool != nullptr)
+				mPool->attach();
 			for (iterator it = a.begin(); it != a.end(); it++)
 			{
 				push_back(*it);
 			}
 		}
 
-		// default constructor
-		list() : mHeader(new node()), mSize(0) {}
+		// default constructor, nodes come from pool when one is given; lists
+		// can only splice nodes (splitList, merge, merge_sorted) between each
+		// other when they share the same pool, otherwise std::invalid_argument
+		list(node_pool *pool = nullptr) : mHeader(new node()), mSize(0), mPool(pool)
+		{
+			if (mPool != nullptr)
+				mPool->attach();
+		}
 
 		// copy assignment operator using copy-and-swap idiom
 		list<T> &operator=(list<T> other)
@@ -99,6 +219,7 @@ namespace CP
 			using std::swap;
 			swap(this->mHeader, other.mHeader);
 			swap(this->mSize, other.mSize);
+			swap(this->mPool, other.mPool);
 			return *this;
 		}
 
@@ -106,6 +227,8 @@ namespace CP
 		{
 			clear();
 			delete mHeader;
+			if (mPool != nullptr)
+				mPool->detach();
 		}
 
 		//------------- capacity function -------------------
@@ -157,7 +280,7 @@ namespace CP
 
 		iterator insert(iterator it, const T &element)
 		{
-			node *n = new node(element, it.ptr->prev, it.ptr);
+			node *n = new_node(element, it.ptr->prev, it.ptr);
 			it.ptr->prev->next = n;
 			it.ptr->prev = n;
 			mSize++;
@@ -169,15 +292,31 @@ namespace CP
 			iterator tmp(it.ptr->next);
 			it.ptr->prev->next = it.ptr->next;
 			it.ptr->next->prev = it.ptr->prev;
-			delete it.ptr;
+			free_node(it.ptr);
 			mSize--;
 			return tmp;
 		}
 
+		// a pool used by this list alone is dropped in one step when the
+		// nodes need no destructor, otherwise nodes are freed in one pass
 		void clear()
 		{
-			while (mSize > 0)
-				erase(begin());
+			if (pooled_nodes<node>::releasable(mPool))
+			{
+				mPool->release();
+			}
+			else
+			{
+				node *n = mHeader->next;
+				while (n != mHeader)
+				{
+					node *next = n->next;
+					free_node(n);
+					n = next;
+				}
+			}
+			mHeader->next = mHeader->prev = mHeader;
+			mSize = 0;
 		}
 
 		void print()
@@ -216,24 +355,44 @@ namespace CP
 			}
 		}
 
+		// moves the elements of [a, b) equal to value to the front of output,
+		// each in front of the one before it; the nodes are relinked when both
+		// lists take nodes from the same place and copied otherwise, freeing
+		// the originals only at the end since value may be one of them
 		void extract(const T &value, iterator a, iterator b, CP::list<T> &output)
 		{
-			for (auto it = a; it != b; ++it)
+			if (&output == this)
+				return;
+			bool relink = (output.mPool == mPool);
+			node *victims = nullptr;
+			node *n = a.ptr;
+			while (n != b.ptr)
 			{
-				if (*it == value)
+				node *next = n->next;
+				if (n->data == value)
 				{
-					node *tem = new node();
-					tem->next = output.mHeader->next;
-					output.mHeader->next->prev = tem;
-					output.mHeader->next = tem;
-					tem->prev = output.mHeader;
-					tem->data = value;
-					++output.mSize;
-					it.ptr->prev->next = it.ptr->next;
-					it.ptr->next->prev = it.ptr->prev;
-					delete it.ptr;
+					if (relink)
+					{
+						splice_nodes(n, n, output.mHeader->next);
+						++output.mSize;
+					}
+					else
+					{
+						output.push_front(n->data);
+						n->prev->next = n->next;
+						n->next->prev = n->prev;
+						n->next = victims;
+						victims = n;
+					}
 					--mSize;
 				}
+				n = next;
+			}
+			while (victims != nullptr)
+			{
+				node *next = victims->next;
+				free_node(victims);
+				victims = next;
 			}
 		}
 
@@ -266,6 +425,8 @@ namespace CP
 
 		void splitList(CP::list<T> &list1, CP::list<T> &list2)
 		{
+			check_pool(list1);
+			check_pool(list2);
 			if (mSize == 0)
 				return;
 			int n = (mSize + 1) / 2;
@@ -292,21 +453,45 @@ namespace CP
 
 		void remove_all(const T &value)
 		{
-			for (auto it = begin(); it != end(); ++it)
+			remove_if([&value](const T &x)
+					  { return x == value; });
+		}
+
+		// unlinks the elements satisfying pred in one pass and frees them
+		// afterwards, so pred may look at a value stored in this list;
+		// returns how many were removed
+		template <typename Pred>
+		size_t remove_if(Pred pred)
+		{
+			node *victims = nullptr;
+			size_t count = 0;
+			node *n = mHeader->next;
+			while (n != mHeader)
 			{
-				if (*it == value)
+				node *next = n->next;
+				if (pred(n->data))
 				{
-					it.ptr->prev->next = it.ptr->next;
-					it.ptr->next->prev = it.ptr->prev;
-					delete it.ptr;
-					--mSize;
+					n->prev->next = next;
+					next->prev = n->prev;
+					n->next = victims;
+					victims = n;
+					++count;
 				}
+				n = next;
+			}
+			mSize -= count;
+			while (victims != nullptr)
+			{
+				node *next = victims->next;
+				free_node(victims);
+				victims = next;
 			}
+			return count;
 		}
 
 		CP::list<T> split(iterator it, size_t pos)
 		{
-			CP::list<T> result;
+			CP::list<T> result(mPool);
 			if (it == end())
 			{
 				return result;
@@ -346,21 +531,137 @@ namespace CP
 
 		void merge(CP::list<CP::list<T>> &ls)
 		{
+			for (auto &x : ls)
+				check_pool(x);
 			for (auto &x : ls)
 			{
-				mHeader->prev->next = x.mHeader->next;
-				x.mHeader->next->prev = mHeader->prev;
-				mHeader->prev = x.mHeader->prev;
-				x.mHeader->prev->next = mHeader;
-
+				if (x.mSize == 0)
+					continue;
+				splice_nodes(x.mHeader->next, x.mHeader->prev, mHeader);
 				mSize += x.mSize;
 				x.mSize = 0;
-
-				x.mHeader->next = x.mHeader;
-				x.mHeader->prev = x.mHeader;
 			}
 			// std::cout<<'\n'<<ls.size();
 		}
+
+		// stable merge sort by relinking, no node is allocated or copied
+		// comp must not throw
+		template <typename Comp = std::less<T>>
+		void sort(Comp comp = Comp())
+		{
+			if (mSize < 2)
+				return;
+			relink(sort_chain(unlink_chain(), comp));
+		}
+
+		// sorts about mSize / threads nodes on each thread, then merges the
+		// sorted chains pairwise, again one merge per thread
+		// comp must not throw
+		template <typename Comp = std::less<T>>
+		void parallel_sort(size_t threads = std::thread::hardware_concurrency(), Comp comp = Comp())
+		{
+			const size_t MIN_PER_THREAD = (size_t)1 << 14;
+			if (threads > mSize / MIN_PER_THREAD)
+				threads = mSize / MIN_PER_THREAD;
+			if (threads < 2)
+			{
+				sort(comp);
+				return;
+			}
+			size_t per = mSize / threads;
+			std::vector<node *> chains(threads);
+			node *n = unlink_chain();
+			for (size_t t = 0; t < threads; ++t)
+			{
+				chains[t] = n;
+				if (t + 1 == threads)
+					break;
+				node *last = n;
+				for (size_t i = 1; i < per; ++i)
+					last = last->next;
+				n = last->next;
+				last->next = nullptr;
+			}
+			std::vector<std::thread> workers;
+			for (size_t t = 0; t < threads; ++t)
+				workers.emplace_back([&chains, t, comp]() mutable
+									 { chains[t] = sort_chain(chains[t], comp); });
+			for (auto &w : workers)
+				w.join();
+			for (size_t step = 1; step < threads; step *= 2)
+			{
+				workers.clear();
+				for (size_t t = 0; t + step < threads; t += 2 * step)
+					workers.emplace_back([&chains, t, step, comp]() mutable
+										 { chains[t] = merge_chains(chains[t], chains[t + step], comp); });
+				for (auto &w : workers)
+					w.join();
+			}
+			relink(chains[0]);
+		}
+
+		// merges the sorted other into this sorted list, leaving other empty;
+		// on ties the elements of this list come first
+		template <typename Comp = std::less<T>>
+		void merge_sorted(CP::list<T> &other, Comp comp = Comp())
+		{
+			check_pool(other);
+			if (&other == this || other.mSize == 0)
+				return;
+			node *a = unlink_chain();
+			node *b = other.unlink_chain();
+			relink(merge_chains(a, b, comp));
+			mSize += other.mSize;
+			other.mSize = 0;
+		}
+
+		// stable: elements satisfying pred keep their order at the front and
+		// the rest keep theirs behind them; returns the first of the rest
+		template <typename Pred>
+		iterator partition(Pred pred)
+		{
+			node *first_false = mHeader;
+			node *n = mHeader->next;
+			for (size_t i = 0; i < mSize; ++i)
+			{
+				node *next = n->next;
+				if (!pred(n->data))
+				{
+					if (first_false == mHeader)
+						first_false = n;
+					splice_nodes(n, n, mHeader);
+				}
+				n = next;
+			}
+			return iterator(first_false);
+		}
+
+		// removes all but the first of each run of equal elements, the runs
+		// are spliced out and freed together; returns how many were removed
+		template <typename Eq = std::equal_to<T>>
+		size_t unique(Eq eq = Eq())
+		{
+			list<T> removed(mPool);
+			node *n = mHeader->next;
+			while (n != mHeader)
+			{
+				node *last = n->next;
+				size_t run = 0;
+				while (last != mHeader && eq(n->data, last->data))
+				{
+					last = last->next;
+					++run;
+				}
+				if (run > 0)
+				{
+					splice_nodes(n->next, last->prev, removed.mHeader);
+					removed.mSize += run;
+				}
+				n = last;
+			}
+			mSize -= removed.mSize;
+			return removed.mSize;
+		}
 	};
 
 }
@@ -0,0 +1,157 @@
+#ifndef _CP_LOSER_TREE_INCLUDED_
+#define _CP_LOSER_TREE_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <functional>
+#include <vector>
+//#pragma once
+
+namespace CP
+{
+
+	// tournament tree for k-way merging
+	// each inner node remembers the loser of the match played there and
+	// node 0 the overall winner (the smallest head under Comp). Replacing the
+	// winner's head replays only the matches on its path to the root, one
+	// comparison per level, where a binary heap needs two. Ties go to the
+	// lower source so merging stays stable
+	template <typename T, typename Comp = std::less<T>>
+	class loser_tree
+	{
+	public:
+		static constexpr size_t npos = (size_t)-1;
+
+	protected:
+		std::vector<size_t> mTree; // mTree[0] winner, mTree[1..k-1] losers
+		std::vector<T> mHead;	   // current head of each source
+		std::vector<bool> mDone;   // source is exhausted
+		size_t mK;
+		size_t mLive;
+		Comp mLess;
+
+		// true when source a wins against source b
+		bool beats(size_t a, size_t b) const
+		{
+			if (mDone[a])
+				return false;
+			if (mDone[b])
+				return true;
+			if (mLess(mHead[a], mHead[b]))
+				return true;
+			if (mLess(mHead[b], mHead[a]))
+				return false;
+			return a < b;
+		}
+
+		// plays the matches from source s up to the root
+		void replay(size_t s)
+		{
+			size_t w = s;
+			for (size_t n = (s + mK) / 2; n > 0; n /= 2)
+			{
+				if (beats(mTree[n], w))
+					std::swap(mTree[n], w);
+			}
+			mTree[0] = w;
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// k sources, all exhausted until set() gives them a head
+		loser_tree(size_t k = 0, const Comp &c = Comp()) : mLess(c)
+		{
+			reset(k);
+		}
+
+		void reset(size_t k)
+		{
+			mK = k;
+			mLive = 0;
+			mTree.assign(k == 0 ? 1 : k, npos);
+			mHead.assign(k, T());
+			mDone.assign(k, true);
+		}
+
+		//------------- capacity function -------------------
+		// true when every source is exhausted
+		bool empty() const
+		{
+			return mLive == 0;
+		}
+
+		size_t sources() const
+		{
+			return mK;
+		}
+
+		//----------------- access -----------------
+		// source of the smallest head, npos when empty
+		size_t top_source() const
+		{
+			return empty() ? npos : mTree[0];
+		}
+
+		const T &top() const
+		{
+			if (empty())
+				throw std::out_of_range("index of out range");
+			return mHead[mTree[0]];
+		}
+
+		//----------------- modifier -------------
+		// first head of source i, call build() once every source is set
+		void set(size_t i, const T &head)
+		{
+			if (i >= mK)
+				throw std::out_of_range("index of out range");
+			if (mDone[i])
+				mLive++;
+			mHead[i] = head;
+			mDone[i] = false;
+		}
+
+		// plays every match bottom-up, O(k)
+		void build()
+		{
+			if (mK == 0)
+				return;
+			std::vector<size_t> win(2 * mK);
+			for (size_t i = 0; i < mK; i++)
+				win[mK + i] = i;
+			for (size_t n = mK - 1; n > 0; n--)
+			{
+				size_t a = win[2 * n], b = win[2 * n + 1];
+				if (beats(b, a))
+					std::swap(a, b);
+				win[n] = a;
+				mTree[n] = b;
+			}
+			mTree[0] = win[1];
+		}
+
+		// the winner's source produced its next element, O(log k)
+		void replace_top(const T &head)
+		{
+			if (empty())
+				throw std::out_of_range("index of out range");
+			size_t s = mTree[0];
+			mHead[s] = head;
+			replay(s);
+		}
+
+		// the winner's source has no more elements, O(log k)
+		void pop_source()
+		{
+			if (empty())
+				throw std::out_of_range("index of out range");
+			size_t s = mTree[0];
+			mDone[s] = true;
+			mLive--;
+			replay(s);
+		}
+	};
+}
+
+#endif
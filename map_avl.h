@@ -2,6 +2,7 @@
 #define _CP_MAP_AVL_INCLUDED_
 
 #include <iostream>
+#include "node_pool.h"
 #include <assert.h>
 //#pragma once
 
@@ -19,6 +20,7 @@ namespace CP
 		class node
 		{
 			friend class map_avl;
+			friend struct pooled_nodes<node>;
 
 		protected:
 			ValueT data;
@@ -139,6 +141,7 @@ namespace CP
 		node *mRoot;
 		CompareT mLess;
 		size_t mSize;
+		node_pool *mPool; // where the nodes come from, nullptr for new/delete
 
 	public:
 		typedef tree_iterator iterator;
@@ -182,11 +185,22 @@ namespace CP
 			}
 			return max;
 		}
+		template <typename... Args>
+		node *new_node(const Args &...args)
+		{
+			return pooled_nodes<node>::create(mPool, args...);
+		}
+
+		void free_node(node *n)
+		{
+			pooled_nodes<node>::destroy(mPool, n);
+		}
+
 		node *copy(node *src, node *parent)
 		{
 			if (src == nullptr)
 				return nullptr;
-			node *tmp = new node();
+			node *tmp = new_node();
 			tmp->data = src->data;
 			tmp->left = copy(src->left, tmp);
 			tmp->right = copy(src->right, tmp);
@@ -195,11 +209,7 @@ namespace CP
 		}
 		void delete_all_nodes(node *r)
 		{
-			if (r == nullptr)
-				return;
-			delete_all_nodes(r->left);
-			delete_all_nodes(r->right);
-			delete r;
+			pooled_nodes<node>::destroy_tree(mPool, r);
 		}
 		node *rotate_left_child(node *r)
 		{
@@ -248,7 +258,7 @@ namespace CP
 			if (r == nullptr)
 			{
 				mSize++;
-				ptr = r = new node(val, nullptr, nullptr, nullptr);
+				ptr = r = new_node(val, nullptr, nullptr, nullptr);
 			}
 			else
 			{
@@ -286,7 +296,7 @@ namespace CP
 				{
 					node *n = r;
 					r = (r->left == nullptr ? r->right : r->left);
-					delete n;
+					free_node(n);
 					mSize--;
 				}
 				else
@@ -307,16 +317,23 @@ namespace CP
 		//-------------- constructor & copy operator ----------
 
 		// copy constructor
-		map_avl(const map_avl<KeyT, MappedT, CompareT> &other) : mLess(other.mLess), mSize(other.mSize)
+		map_avl(const map_avl<KeyT, MappedT, CompareT> &other) : mLess(other.mLess), mSize(other.mSize), mPool(other.mPool)
 		{
+			if (mPool != nullptr)
+				mPool->attach();
 			mRoot = copy(other.mRoot, nullptr);
 		}
 
-		// default constructor
-		map_avl(const CompareT &c = CompareT()) : mRoot(nullptr), mLess(c), mSize(0)
+		// default constructor, nodes come from pool when one is given; maps
+		// can only move nodes between each other when they share the pool
+		map_avl(const CompareT &c = CompareT(), node_pool *pool = nullptr) : mRoot(nullptr), mLess(c), mSize(0), mPool(pool)
 		{
+			if (mPool != nullptr)
+				mPool->attach();
 		}
 
+		explicit map_avl(node_pool *pool) : map_avl(CompareT(), pool) {}
+
 		// copy assignment operator using copy-and-swap idiom
 		map_avl<KeyT, MappedT, CompareT> &operator=(map_avl<KeyT, MappedT, CompareT> other)
 		{
@@ -326,12 +343,15 @@ namespace CP
 			swap(this->mRoot, other.mRoot);
 			swap(this->mLess, other.mLess);
 			swap(this->mSize, other.mSize);
+			swap(this->mPool, other.mPool);
 			return *this;
 		}
 
 		~map_avl()
 		{
 			clear();
+			if (mPool != nullptr)
+				mPool->detach();
 		}
 
 		bool empty()
@@ -2,6 +2,7 @@
 #define _CP_MAP_BST_INCLUDED_
 
 #include <iostream>
+#include "node_pool.h"
 //#pragma once
 
 namespace CP
@@ -18,6 +19,7 @@ namespace CP
 		class node
 		{
 			friend class map_bst;
+			friend struct pooled_nodes<node>;
 
 		protected:
 			ValueT data;
@@ -107,6 +109,7 @@ namespace CP
 		node *mRoot;
 		CompareT mLess;
 		size_t mSize;
+		node_pool *mPool; // where the nodes come from, nullptr for new/delete
 
 	public:
 		typedef tree_iterator iterator;
@@ -162,11 +165,22 @@ namespace CP
 			return max;
 		}
 
+		template <typename... Args>
+		node *new_node(const Args &...args)
+		{
+			return pooled_nodes<node>::create(mPool, args...);
+		}
+
+		void free_node(node *n)
+		{
+			pooled_nodes<node>::destroy(mPool, n);
+		}
+
 		node *copy(node *src, node *parent)
 		{
 			if (src == nullptr)
 				return nullptr;
-			node *tmp = new node();
+			node *tmp = new_node();
 			tmp->data = src->data;
 			tmp->left = copy(src->left, tmp);
 			tmp->right = copy(src->right, tmp);
@@ -175,27 +189,31 @@ namespace CP
 		}
 		void delete_all_nodes(node *r)
 		{
-			if (r == nullptr)
-				return;
-			delete_all_nodes(r->left);
-			delete_all_nodes(r->right);
-			delete r;
+			pooled_nodes<node>::destroy_tree(mPool, r);
 		}
 
 	public:
 		//-------------- constructor & copy operator ----------
 
 		// copy constructor
-		map_bst(const map_bst<KeyT, MappedT, CompareT> &other) : mLess(other.mLess), mSize(other.mSize)
+		map_bst(const map_bst<KeyT, MappedT, CompareT> &other) : mLess(other.mLess), mSize(other.mSize), mPool(other.mPool)
 		{
+			if (mPool != nullptr)
+				mPool->attach();
 			mRoot = copy(other.mRoot, nullptr);
 		}
 
-		// default constructor
-		map_bst(const CompareT &c = CompareT()) : mRoot(nullptr), mLess(c), mSize(0)
+		// default constructor, nodes come from pool when one is given; maps
+		// can only move nodes between each other (subtree) when they share
+		// the pool, otherwise std::invalid_argument
+		map_bst(const CompareT &c = CompareT(), node_pool *pool = nullptr) : mRoot(nullptr), mLess(c), mSize(0), mPool(pool)
 		{
+			if (mPool != nullptr)
+				mPool->attach();
 		}
 
+		explicit map_bst(node_pool *pool) : map_bst(CompareT(), pool) {}
+
 		// copy assignment operator using copy-and-swap idiom
 		map_bst<KeyT, MappedT, CompareT> &operator=(map_bst<KeyT, MappedT, CompareT> other)
 		{
@@ -205,12 +223,15 @@ namespace CP
 			swap(this->mRoot, other.mRoot);
 			swap(this->mLess, other.mLess);
 			swap(this->mSize, other.mSize);
+			swap(this->mPool, other.mPool);
 			return *this;
 		}
 
 		~map_bst()
 		{
 			clear();
+			if (mPool != nullptr)
+				mPool->detach();
 		}
 
 		//------------- capacity function -------------------
@@ -249,7 +270,7 @@ namespace CP
 			node *ptr = find_node(key, mRoot, parent);
 			if (ptr == nullptr)
 			{
-				ptr = new node(std::make_pair(key, MappedT()), nullptr, nullptr, parent);
+				ptr = new_node(std::make_pair(key, MappedT()), nullptr, nullptr, parent);
 				child_link(parent, key) = ptr;
 				mSize++;
 			}
@@ -263,7 +284,7 @@ namespace CP
 			bool not_found = (ptr == nullptr);
 			if (not_found)
 			{
-				ptr = new node(val, nullptr, nullptr, parent);
+				ptr = new_node(val, nullptr, nullptr, parent);
 				child_link(parent, val.first) = ptr;
 				mSize++;
 			}
@@ -305,7 +326,7 @@ namespace CP
 				if (link != nullptr)
 					link->parent = ptr->parent;
 			}
-			delete ptr;
+			free_node(ptr);
 			mSize--;
 			return 1;
 		}
@@ -492,6 +513,8 @@ namespace CP
 
 		std::pair<KeyT, MappedT> subtree(map_bst<KeyT, MappedT, CompareT> &left, map_bst<KeyT, MappedT, CompareT> &right)
 		{
+			if (left.mPool != mPool || right.mPool != mPool)
+				throw std::invalid_argument("maps do not share a node pool");
 			if (mRoot == nullptr)
 				return std::pair<KeyT, MappedT>();
 			if (mSize == 1)
@@ -518,7 +541,7 @@ namespace CP
 		}
 		CP::map_bst<KeyT, MappedT, CompareT> split(KeyT val)
 		{
-			CP::map_bst<KeyT, MappedT, CompareT> result;
+			CP::map_bst<KeyT, MappedT, CompareT> result(mLess, mPool);
 			node *p = mRoot;
 			node *lastResult = NULL; 
 			node *lastUs = NULL;	 
@@ -0,0 +1,236 @@
+#ifndef _CP_MINMAX_HEAP_INCLUDED_
+#define _CP_MINMAX_HEAP_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <utility>
+//#pragma once
+
+namespace CP
+{
+
+	// double-ended heap in one array
+	// levels alternate: a node on an even level (the root is level 0) is the
+	// smallest of its subtree, a node on an odd level the largest. min() is
+	// the root and max() one of its two children. With a bound the heap keeps
+	// the largest elements only, a push into a full heap evicts min()
+	template <typename T, typename Comp = std::less<T>>
+	class minmax_heap
+	{
+	protected:
+		std::vector<T> mData;
+		size_t mBound; // 0 means unbounded
+		Comp mLess;
+
+		static size_t parent(size_t idx)
+		{
+			return (idx - 1) / 2;
+		}
+
+		static bool is_min_level(size_t idx)
+		{
+			int l = 0;
+			for (idx++; idx > 1; idx >>= 1)
+				l++;
+			return (l & 1) == 0;
+		}
+
+		// a on a min level must not be greater than b, the other way round on
+		// a max level
+		bool before(bool minLevel, const T &a, const T &b) const
+		{
+			return minLevel ? mLess(a, b) : mLess(b, a);
+		}
+
+		void bubbleUp(size_t idx, bool minLevel)
+		{
+			// same-type ancestors are grandparents
+			while (idx >= 3)
+			{
+				size_t g = parent(parent(idx));
+				if (!before(minLevel, mData[idx], mData[g]))
+					break;
+				std::swap(mData[idx], mData[g]);
+				idx = g;
+			}
+		}
+
+		void fixUp(size_t idx)
+		{
+			if (idx == 0)
+				return;
+			bool minLevel = is_min_level(idx);
+			size_t p = parent(idx);
+			if (before(!minLevel, mData[idx], mData[p]))
+			{
+				std::swap(mData[idx], mData[p]);
+				bubbleUp(p, !minLevel);
+				return;
+			}
+			bubbleUp(idx, minLevel);
+		}
+
+		void fixDown(size_t idx)
+		{
+			bool minLevel = is_min_level(idx);
+			size_t n = mData.size();
+			while (2 * idx + 1 < n)
+			{
+				// best among children and grandchildren for this level type
+				size_t m = 2 * idx + 1;
+				size_t c = m;
+				if (c + 1 < n && before(minLevel, mData[c + 1], mData[m]))
+					m = c + 1;
+				size_t g = 2 * c + 1;
+				for (size_t i = g; i < g + 4 && i < n; i++)
+				{
+					if (before(minLevel, mData[i], mData[m]))
+						m = i;
+				}
+				if (!before(minLevel, mData[m], mData[idx]))
+					break;
+				std::swap(mData[m], mData[idx]);
+				if (m <= c + 1)
+					break; // a child has no descendants to reorder
+				size_t p = parent(m);
+				if (before(!minLevel, mData[m], mData[p]))
+					std::swap(mData[m], mData[p]);
+				idx = m;
+			}
+		}
+
+		size_t max_pos() const
+		{
+			if (mData.size() <= 2)
+				return mData.size() - 1;
+			return mLess(mData[1], mData[2]) ? 2 : 1;
+		}
+
+		void remove_at(size_t pos)
+		{
+			mData[pos] = mData.back();
+			mData.pop_back();
+			if (pos < mData.size())
+			{
+				fixUp(pos);
+				fixDown(pos);
+			}
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// default constructor
+		minmax_heap(const Comp &c = Comp()) : mBound(0), mLess(c) {}
+
+		// keeps at most bound elements, dropping the smallest
+		explicit minmax_heap(size_t bound, const Comp &c = Comp()) : mBound(bound), mLess(c)
+		{
+			mData.reserve(bound);
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mData.empty();
+		}
+
+		size_t size() const
+		{
+			return mData.size();
+		}
+
+		size_t bound() const
+		{
+			return mBound;
+		}
+
+		//----------------- access -----------------
+		const T &min() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mData[0];
+		}
+
+		const T &max() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mData[max_pos()];
+		}
+
+		//----------------- modifier -------------
+		void push(const T &element)
+		{
+			if (mBound != 0 && mData.size() >= mBound)
+			{
+				// full: the new element replaces the minimum if it beats it
+				if (!mLess(mData[0], element))
+					return;
+				mData[0] = element;
+				fixDown(0);
+				return;
+			}
+			mData.push_back(element);
+			fixUp(mData.size() - 1);
+		}
+
+		void pop_min()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			remove_at(0);
+		}
+
+		void pop_max()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			remove_at(max_pos());
+		}
+
+		void clear()
+		{
+			mData.clear();
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		void erase(const T &v)
+		{
+			for (size_t i = 0; i < mData.size(); ++i)
+			{
+				if (v == mData[i])
+				{
+					remove_at(i);
+					return;
+				}
+			}
+		}
+
+		bool find(const T &v) const
+		{
+			for (size_t i = 0; i < mData.size(); ++i)
+			{
+				if (v == mData[i])
+					return true;
+			}
+			return false;
+		}
+
+		// works in both directions: moving through the parent leaves the old
+		// parent value at pos, which then sifts into the subtree
+		void change_value(size_t pos, const T &value)
+		{
+			if (pos >= mData.size())
+				throw std::out_of_range("index of out range");
+			mData[pos] = value;
+			fixUp(pos);
+			fixDown(pos);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,275 @@
+#ifndef _CP_MPMC_QUEUE_INCLUDED_
+#define _CP_MPMC_QUEUE_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+//#pragma once
+
+namespace CP
+{
+
+	// bounded multi-producer/multi-consumer queue
+	// every slot carries a sequence number telling whether it is ready for a
+	// producer (seq == pos) or for a consumer (seq == pos + 1), so producers
+	// and consumers only contend on their own end of the ring
+	template <typename T>
+	class mpmc_queue
+	{
+	protected:
+		struct slot
+		{
+			std::atomic<size_t> seq;
+			T data;
+
+			slot() : seq(0), data(T()) {}
+		};
+
+		slot *mData;
+		size_t mCap;
+		size_t mMask;
+
+		alignas(64) std::atomic<size_t> mTail; // next position to push
+		alignas(64) std::atomic<size_t> mHead; // next position to pop
+
+		alignas(64) std::mutex mLock; // only used to park blocked threads
+		std::condition_variable mNotEmpty;
+		std::condition_variable mNotFull;
+		std::atomic<size_t> mPopWaiters;
+		std::atomic<size_t> mPushWaiters;
+		size_t mPopEpoch;  // guarded by mLock
+		size_t mPushEpoch; // guarded by mLock
+
+		static size_t round_up(size_t capacity)
+		{
+			size_t c = 2;
+			while (c < capacity)
+				c <<= 1;
+			return c;
+		}
+
+		void wake(std::atomic<size_t> &waiters, size_t &epoch, std::condition_variable &cv, bool all = false)
+		{
+			// pairs with the fetch_add in the waiting thread so that either the
+			// waiter sees our slot update or we see the waiter
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (waiters.load(std::memory_order_relaxed) > 0)
+			{
+				std::lock_guard<std::mutex> lk(mLock);
+				epoch++;
+				if (all)
+					cv.notify_all();
+				else
+					cv.notify_one();
+			}
+		}
+
+		template <typename Op>
+		bool park(Op op, std::atomic<size_t> &waiters, size_t &epoch, std::condition_variable &cv,
+				  const std::chrono::steady_clock::time_point *deadline)
+		{
+			// spin a little before going to sleep
+			for (int i = 0; i < 64; ++i)
+			{
+				if (op())
+					return true;
+			}
+			waiters.fetch_add(1, std::memory_order_seq_cst);
+			std::unique_lock<std::mutex> lk(mLock, std::defer_lock);
+			bool ok;
+			while (true)
+			{
+				// the epoch is read before retrying so a wake-up between the
+				// failed retry and the wait below is not lost
+				lk.lock();
+				size_t e = epoch;
+				lk.unlock();
+				if ((ok = op()))
+					break;
+				lk.lock();
+				if (deadline == nullptr)
+					cv.wait(lk, [&]() { return epoch != e; });
+				else if (!cv.wait_until(lk, *deadline, [&]() { return epoch != e; }))
+				{
+					lk.unlock();
+					ok = op();
+					break;
+				}
+				lk.unlock();
+			}
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+			return ok;
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// constructor with capacity (rounded up to a power of two)
+		mpmc_queue(size_t capacity = 1024) : mCap(round_up(capacity)), mTail(0), mHead(0),
+											 mPopWaiters(0), mPushWaiters(0), mPopEpoch(0), mPushEpoch(0)
+		{
+			mMask = mCap - 1;
+			mData = new slot[mCap]();
+			for (size_t i = 0; i < mCap; i++)
+			{
+				mData[i].seq.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		mpmc_queue(const mpmc_queue<T> &) = delete;
+		mpmc_queue<T> &operator=(const mpmc_queue<T> &) = delete;
+
+		~mpmc_queue()
+		{
+			delete[] mData;
+		}
+
+		//------------- capacity function -------------------
+		// size() and empty() are only a snapshot while other threads are running
+		bool empty() const
+		{
+			return size() == 0;
+		}
+
+		size_t size() const
+		{
+			size_t head = mHead.load(std::memory_order_acquire);
+			size_t tail = mTail.load(std::memory_order_acquire);
+			return tail > head ? tail - head : 0;
+		}
+
+		size_t capacity() const
+		{
+			return mCap;
+		}
+
+		//----------------- modifier -------------
+		bool try_push(const T &element)
+		{
+			size_t pos = mTail.load(std::memory_order_relaxed);
+			slot *s;
+			while (true)
+			{
+				s = &mData[pos & mMask];
+				size_t seq = s->seq.load(std::memory_order_acquire);
+				std::ptrdiff_t dif = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+				if (dif == 0)
+				{
+					if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (dif < 0)
+					return false; // full
+				else
+					pos = mTail.load(std::memory_order_relaxed);
+			}
+			s->data = element;
+			s->seq.store(pos + 1, std::memory_order_release);
+			wake(mPopWaiters, mPopEpoch, mNotEmpty);
+			return true;
+		}
+
+		bool try_pop(T &out)
+		{
+			size_t pos = mHead.load(std::memory_order_relaxed);
+			slot *s;
+			while (true)
+			{
+				s = &mData[pos & mMask];
+				size_t seq = s->seq.load(std::memory_order_acquire);
+				std::ptrdiff_t dif = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+				if (dif == 0)
+				{
+					if (mHead.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (dif < 0)
+					return false; // empty
+				else
+					pos = mHead.load(std::memory_order_relaxed);
+			}
+			out = std::move(s->data);
+			s->seq.store(pos + mCap, std::memory_order_release);
+			wake(mPushWaiters, mPushEpoch, mNotFull);
+			return true;
+		}
+
+		// blocks until there is room
+		void push(const T &element)
+		{
+			park([&]() { return try_push(element); }, mPushWaiters, mPushEpoch, mNotFull, nullptr);
+		}
+
+		// blocks until there is room or the timeout expires
+		template <typename Rep, typename Period>
+		bool push(const T &element, const std::chrono::duration<Rep, Period> &timeout)
+		{
+			auto deadline = std::chrono::steady_clock::now() +
+							std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+			return park([&]() { return try_push(element); }, mPushWaiters, mPushEpoch, mNotFull, &deadline);
+		}
+
+		// blocks until an element is available
+		void pop(T &out)
+		{
+			park([&]() { return try_pop(out); }, mPopWaiters, mPopEpoch, mNotEmpty, nullptr);
+		}
+
+		// blocks until an element is available or the timeout expires
+		template <typename Rep, typename Period>
+		bool pop(T &out, const std::chrono::duration<Rep, Period> &timeout)
+		{
+			auto deadline = std::chrono::steady_clock::now() +
+							std::chrono::duration_cast<std::chrono::steady_clock::duration>(timeout);
+			return park([&]() { return try_pop(out); }, mPopWaiters, mPopEpoch, mNotEmpty, &deadline);
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		// pops up to max elements into out and returns how many were taken
+		// a run of ready slots is claimed with a single CAS on the head
+		size_t drain(std::vector<T> &out, size_t max)
+		{
+			if (max == 0)
+				return 0;
+			size_t pos = mHead.load(std::memory_order_relaxed);
+			size_t n;
+			while (true)
+			{
+				n = 0;
+				while (n < max && n < mCap)
+				{
+					size_t seq = mData[(pos + n) & mMask].seq.load(std::memory_order_acquire);
+					if (seq != pos + n + 1)
+						break;
+					n++;
+				}
+				if (n == 0)
+				{
+					// either empty or another consumer moved the head
+					size_t now = mHead.load(std::memory_order_relaxed);
+					if (now == pos)
+						return 0;
+					pos = now;
+					continue;
+				}
+				if (mHead.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+					break;
+			}
+			out.reserve(out.size() + n);
+			for (size_t i = 0; i < n; i++)
+			{
+				slot &s = mData[(pos + i) & mMask];
+				out.push_back(std::move(s.data));
+				s.seq.store(pos + i + mCap, std::memory_order_release);
+			}
+			wake(mPushWaiters, mPushEpoch, mNotFull, true);
+			return n;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,276 @@
+#ifndef _CP_NODE_POOL_INCLUDED_
+#define _CP_NODE_POOL_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <type_traits>
+//#pragma once
+
+namespace CP
+{
+
+	// slab allocator for the nodes of the linked containers
+	// requests are rounded up to a size class of GRANULE bytes; each class
+	// carves its nodes from large slabs and recycles freed nodes through a
+	// free list threaded through the nodes themselves, so allocate and
+	// deallocate are O(1). release() drops every slab at once without looking
+	// at the nodes; blocks too large for a class are linked into a list of
+	// their own so release() frees them too. A pool is not thread-safe;
+	// this_thread() gives each thread
+	// its own. Containers sharing a pool attach() to it, and a container may
+	// only release() the pool on clear() while it is the single user. Any
+	// other code calling allocate() directly must attach() as well, or its
+	// nodes are freed under it when that container clears
+	class node_pool
+	{
+	public:
+		static const size_t GRANULE = 16;
+		// guaranteed alignment of a pooled node
+		static const size_t ALIGNMENT = __STDCPP_DEFAULT_NEW_ALIGNMENT__ < GRANULE ? __STDCPP_DEFAULT_NEW_ALIGNMENT__ : GRANULE;
+
+	protected:
+		static const size_t CLASSES = 16; // up to 256 byte nodes
+		static const size_t SLAB = 64 * 1024;
+
+		struct free_node
+		{
+			free_node *next;
+		};
+
+		// header in front of a block larger than any size class
+		struct large_block
+		{
+			large_block *prev;
+			large_block *next;
+		};
+		static const size_t LARGE_HEADER = (sizeof(large_block) + GRANULE - 1) / GRANULE * GRANULE;
+
+		struct size_class
+		{
+			free_node *free;
+			char *cursor; // unused part of the newest slab of this class
+			char *end;
+		};
+
+		size_class mClass[CLASSES];
+		std::vector<void *> mSlabs;
+		large_block mLarge; // sentinel of the large blocks
+		size_t mUsers;
+		size_t mLive;
+
+		static size_t class_of(size_t bytes)
+		{
+			return (bytes + GRANULE - 1) / GRANULE - 1;
+		}
+
+		void reset_classes()
+		{
+			for (size_class &c : mClass)
+			{
+				c.free = nullptr;
+				c.cursor = c.end = nullptr;
+			}
+		}
+
+	public:
+		//-------------- constructor ----------
+		node_pool() : mUsers(0), mLive(0)
+		{
+			reset_classes();
+			mLarge.prev = mLarge.next = &mLarge;
+		}
+
+		node_pool(const node_pool &) = delete;
+		node_pool &operator=(const node_pool &) = delete;
+
+		~node_pool()
+		{
+			release();
+		}
+
+		// a pool shared by the containers of the calling thread
+		static node_pool &this_thread()
+		{
+			static thread_local node_pool pool;
+			return pool;
+		}
+
+		//------------- capacity function -------------------
+		// nodes handed out and not yet returned
+		size_t live() const
+		{
+			return mLive;
+		}
+
+		size_t users() const
+		{
+			return mUsers;
+		}
+
+		//----------------- modifier -------------
+		void attach()
+		{
+			mUsers++;
+		}
+
+		void detach()
+		{
+			mUsers--;
+		}
+
+		void *allocate(size_t bytes)
+		{
+			if (bytes == 0)
+				bytes = 1;
+			mLive++;
+			if (bytes > GRANULE * CLASSES)
+			{
+				large_block *b = static_cast<large_block *>(::operator new(LARGE_HEADER + bytes));
+				b->prev = &mLarge;
+				b->next = mLarge.next;
+				mLarge.next->prev = b;
+				mLarge.next = b;
+				return reinterpret_cast<char *>(b) + LARGE_HEADER;
+			}
+			size_class &c = mClass[class_of(bytes)];
+			if (c.free != nullptr)
+			{
+				free_node *n = c.free;
+				c.free = n->next;
+				return n;
+			}
+			size_t sz = (class_of(bytes) + 1) * GRANULE;
+			if (c.cursor == nullptr || c.cursor + sz > c.end)
+			{
+				char *slab = static_cast<char *>(::operator new(SLAB));
+				mSlabs.push_back(slab);
+				c.cursor = slab;
+				c.end = slab + SLAB;
+			}
+			void *p = c.cursor;
+			c.cursor += sz;
+			return p;
+		}
+
+		void deallocate(void *p, size_t bytes)
+		{
+			if (p == nullptr)
+				return;
+			if (bytes == 0)
+				bytes = 1;
+			mLive--;
+			if (bytes > GRANULE * CLASSES)
+			{
+				large_block *b = reinterpret_cast<large_block *>(static_cast<char *>(p) - LARGE_HEADER);
+				b->prev->next = b->next;
+				b->next->prev = b->prev;
+				::operator delete(b);
+				return;
+			}
+			size_class &c = mClass[class_of(bytes)];
+			free_node *n = static_cast<free_node *>(p);
+			n->next = c.free;
+			c.free = n;
+		}
+
+		// frees every slab and large block; all nodes from this pool become
+		// invalid and their destructors are not run
+		void release()
+		{
+			for (void *s : mSlabs)
+				::operator delete(s);
+			mSlabs.clear();
+			for (large_block *b = mLarge.next; b != &mLarge;)
+			{
+				large_block *next = b->next;
+				::operator delete(b);
+				b = next;
+			}
+			mLarge.prev = mLarge.next = &mLarge;
+			reset_classes();
+			mLive = 0;
+		}
+	};
+
+	// where a container's nodes come from: its pool when it has one and the
+	// node fits the pool's alignment, new/delete otherwise. A node class
+	// declares this a friend so destroy_tree can reach left and right
+	template <typename Node>
+	struct pooled_nodes
+	{
+		static bool pooled(node_pool *pool)
+		{
+			return pool != nullptr && alignof(Node) <= node_pool::ALIGNMENT;
+		}
+
+		template <typename... Args>
+		static Node *create(node_pool *pool, const Args &...args)
+		{
+			if (!pooled(pool))
+				return new Node(args...);
+			void *p = pool->allocate(sizeof(Node));
+			try
+			{
+				return new (p) Node(args...);
+			}
+			catch (...)
+			{
+				pool->deallocate(p, sizeof(Node));
+				throw;
+			}
+		}
+
+		static void destroy(node_pool *pool, Node *n)
+		{
+			if (pooled(pool))
+			{
+				n->~Node();
+				pool->deallocate(n, sizeof(Node));
+			}
+			else
+				delete n;
+		}
+
+		// a pool used by one container alone can be dropped in one step
+		// instead of freeing its nodes, as long as they need no destructor;
+		// this trusts users() to count everyone holding nodes of the pool
+		static bool releasable(node_pool *pool)
+		{
+			return pooled(pool) && pool->users() == 1 && std::is_trivially_destructible<Node>::value;
+		}
+
+		// frees a binary tree, releasing the pool when releasable(); otherwise
+		// left children are rotated up so one pass frees it without recursion
+		static void destroy_tree(node_pool *pool, Node *r)
+		{
+			if (r == nullptr)
+				return;
+			if (releasable(pool))
+			{
+				pool->release();
+				return;
+			}
+			while (r != nullptr)
+			{
+				if (r->left != nullptr)
+				{
+					Node *l = r->left;
+					r->left = l->right;
+					l->right = r;
+					r = l;
+				}
+				else
+				{
+					Node *next = r->right;
+					destroy(pool, r);
+					r = next;
+				}
+			}
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,390 @@
+#ifndef _CP_PAIRING_HEAP_INCLUDED_
+#define _CP_PAIRING_HEAP_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <functional>
+#include <vector>
+//#pragma once
+
+namespace CP
+{
+
+	// meldable max-heap with the same ordering as CP::priority_queue
+	// (top() is the largest element under Comp)
+	// push/top/merge are O(1), pop/erase are O(log n) amortized and improving
+	// a key through its handle only relinks that node's subtree. Nodes come
+	// from a pool owned by the heap; merge() takes over the other heap's pool
+	template <typename T, typename Comp = std::less<T>>
+	class pairing_heap
+	{
+	protected:
+		class node
+		{
+			friend class pairing_heap;
+
+		protected:
+			T data;
+			node *child;   // leftmost child
+			node *sibling; // next sibling to the right, or next free node
+			node *prev;	   // left sibling, or parent for a leftmost child
+
+		public:
+			node() : data(T()), child(nullptr), sibling(nullptr), prev(nullptr) {}
+
+			const T &value() const { return data; }
+		};
+
+		struct block
+		{
+			node *nodes;
+			block *next;
+		};
+
+	public:
+		typedef node *handle;
+
+	protected:
+		node *mRoot;
+		size_t mSize;
+		Comp mLess;
+		block *mBlocks; // every block of nodes ever allocated by this heap
+		block *mBlocksTail;
+		node *mFree; // free nodes linked through sibling
+		node *mFreeTail;
+		size_t mNextBlock;
+
+		node *new_node(const T &element)
+		{
+			if (mFree == nullptr)
+			{
+				block *b = new block();
+				b->nodes = new node[mNextBlock];
+				b->next = nullptr;
+				if (mBlocksTail == nullptr)
+					mBlocks = b;
+				else
+					mBlocksTail->next = b;
+				mBlocksTail = b;
+				for (size_t i = 0; i + 1 < mNextBlock; i++)
+				{
+					b->nodes[i].sibling = &b->nodes[i + 1];
+				}
+				mFree = &b->nodes[0];
+				mFreeTail = &b->nodes[mNextBlock - 1];
+				if (mNextBlock < 4096)
+					mNextBlock *= 2;
+			}
+			node *n = mFree;
+			mFree = n->sibling;
+			if (mFree == nullptr)
+				mFreeTail = nullptr;
+			n->data = element;
+			n->child = n->sibling = n->prev = nullptr;
+			return n;
+		}
+
+		void free_node(node *n)
+		{
+			n->child = n->prev = nullptr;
+			n->sibling = mFree;
+			mFree = n;
+			if (mFreeTail == nullptr)
+				mFreeTail = n;
+		}
+
+		// a and b are roots; the smaller becomes the leftmost child of the larger
+		node *link(node *a, node *b)
+		{
+			if (mLess(a->data, b->data))
+				std::swap(a, b);
+			b->sibling = a->child;
+			if (a->child != nullptr)
+				a->child->prev = b;
+			b->prev = a;
+			a->child = b;
+			a->sibling = nullptr;
+			a->prev = nullptr;
+			return a;
+		}
+
+		node *meld(node *a, node *b)
+		{
+			if (a == nullptr)
+				return b;
+			if (b == nullptr)
+				return a;
+			return link(a, b);
+		}
+
+		// unlinks the subtree rooted at n from its parent and siblings
+		void cut(node *n)
+		{
+			if (n->prev->child == n)
+				n->prev->child = n->sibling;
+			else
+				n->prev->sibling = n->sibling;
+			if (n->sibling != nullptr)
+				n->sibling->prev = n->prev;
+			n->sibling = nullptr;
+			n->prev = nullptr;
+		}
+
+		// two-pass pairing of a sibling list into a single root
+		node *combine(node *first)
+		{
+			if (first == nullptr)
+				return nullptr;
+			node *pairs = nullptr; // melded pairs, last pair on top
+			while (first != nullptr)
+			{
+				node *a = first;
+				node *b = a->sibling;
+				if (b == nullptr)
+				{
+					first = nullptr;
+					a->prev = nullptr;
+				}
+				else
+				{
+					first = b->sibling;
+					a->sibling = b->sibling = nullptr;
+					a->prev = b->prev = nullptr;
+					a = link(a, b);
+				}
+				a->sibling = pairs;
+				pairs = a;
+			}
+			node *r = pairs;
+			pairs = pairs->sibling;
+			r->sibling = nullptr;
+			while (pairs != nullptr)
+			{
+				node *n = pairs;
+				pairs = pairs->sibling;
+				n->sibling = nullptr;
+				r = link(r, n);
+			}
+			return r;
+		}
+
+		// depth-first search, skipping subtrees whose root is smaller than v
+		node *find_node(const T &v) const
+		{
+			if (mRoot == nullptr)
+				return nullptr;
+			std::vector<node *> stack(1, mRoot);
+			while (!stack.empty())
+			{
+				node *n = stack.back();
+				stack.pop_back();
+				if (n->data == v)
+					return n;
+				for (node *c = n->child; c != nullptr; c = c->sibling)
+				{
+					if (!mLess(c->data, v))
+						stack.push_back(c);
+				}
+			}
+			return nullptr;
+		}
+
+		void release_blocks()
+		{
+			while (mBlocks != nullptr)
+			{
+				block *b = mBlocks;
+				mBlocks = b->next;
+				delete[] b->nodes;
+				delete b;
+			}
+			mBlocksTail = nullptr;
+			mFree = mFreeTail = nullptr;
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// copy constructor
+		pairing_heap(const pairing_heap<T, Comp> &a) : pairing_heap(a.mLess)
+		{
+			if (a.mRoot == nullptr)
+				return;
+			std::vector<node *> stack(1, a.mRoot);
+			while (!stack.empty())
+			{
+				node *n = stack.back();
+				stack.pop_back();
+				push(n->data);
+				for (node *c = n->child; c != nullptr; c = c->sibling)
+					stack.push_back(c);
+			}
+		}
+
+		// default constructor
+		pairing_heap(const Comp &c = Comp()) : mRoot(nullptr), mSize(0), mLess(c), mBlocks(nullptr), mBlocksTail(nullptr),
+											   mFree(nullptr), mFreeTail(nullptr), mNextBlock(16)
+		{
+		}
+
+		// copy assignment operator
+		pairing_heap<T, Comp> &operator=(pairing_heap<T, Comp> other)
+		{
+			using std::swap;
+			swap(mRoot, other.mRoot);
+			swap(mSize, other.mSize);
+			swap(mLess, other.mLess);
+			swap(mBlocks, other.mBlocks);
+			swap(mBlocksTail, other.mBlocksTail);
+			swap(mFree, other.mFree);
+			swap(mFreeTail, other.mFreeTail);
+			swap(mNextBlock, other.mNextBlock);
+			return *this;
+		}
+
+		~pairing_heap()
+		{
+			release_blocks();
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		//----------------- access -----------------
+		const T &top() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mRoot->data;
+		}
+
+		handle top_handle() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mRoot;
+		}
+
+		//----------------- modifier -------------
+		handle push(const T &element)
+		{
+			node *n = new_node(element);
+			mRoot = meld(mRoot, n);
+			mSize++;
+			return n;
+		}
+
+		void pop()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			node *old = mRoot;
+			mRoot = combine(old->child);
+			free_node(old);
+			mSize--;
+		}
+
+		// all nodes go back to the pool in one step
+		void clear()
+		{
+			release_blocks();
+			mRoot = nullptr;
+			mSize = 0;
+			mNextBlock = 16;
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		// O(1): takes every element of other, which is left empty
+		void merge(pairing_heap<T, Comp> &other)
+		{
+			if (&other == this || other.mRoot == nullptr)
+				return;
+			mRoot = meld(mRoot, other.mRoot);
+			mSize += other.mSize;
+			// adopt other's blocks and free nodes, they now belong to this pool
+			if (other.mBlocks != nullptr)
+			{
+				if (mBlocksTail == nullptr)
+					mBlocks = other.mBlocks;
+				else
+					mBlocksTail->next = other.mBlocks;
+				mBlocksTail = other.mBlocksTail;
+			}
+			if (other.mFree != nullptr)
+			{
+				if (mFreeTail == nullptr)
+					mFree = other.mFree;
+				else
+					mFreeTail->sibling = other.mFree;
+				mFreeTail = other.mFreeTail;
+			}
+			other.mRoot = nullptr;
+			other.mSize = 0;
+			other.mBlocks = other.mBlocksTail = nullptr;
+			other.mFree = other.mFreeTail = nullptr;
+		}
+
+		void erase(handle h)
+		{
+			if (h == mRoot)
+			{
+				pop();
+				return;
+			}
+			cut(h);
+			mRoot = meld(mRoot, combine(h->child));
+			free_node(h);
+			mSize--;
+		}
+
+		void erase(const T &v)
+		{
+			node *n = find_node(v);
+			if (n != nullptr)
+				erase(n);
+		}
+
+		bool find(const T &v) const
+		{
+			return find_node(v) != nullptr;
+		}
+
+		// works in both directions; moving towards the top (decrease-key for
+		// a min-heap) only cuts and relinks the node's subtree
+		void change_value(handle h, const T &value)
+		{
+			bool worse = mLess(value, h->data);
+			h->data = value;
+			if (!worse)
+			{
+				if (h != mRoot)
+				{
+					cut(h);
+					mRoot = link(mRoot, h);
+				}
+				return;
+			}
+			// the children may now beat h: detach them and meld everything back
+			node *kids = combine(h->child);
+			h->child = nullptr;
+			if (h != mRoot)
+			{
+				cut(h);
+				mRoot = meld(mRoot, kids);
+			}
+			else
+				mRoot = kids;
+			mRoot = meld(mRoot, h);
+		}
+	};
+}
+
+#endif
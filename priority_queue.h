@@ -3,39 +3,203 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <new>
+#include <type_traits>
+#include <functional>
+#include <iterator>
 //#pragma once
 
 namespace CP
 {
 
-	template <typename T, typename Comp = std::less<T>>
+	// Arity is the number of children per node (2, 4, 8, 16, ...)
+	// the children of node i are at Arity * i + 1 ... Arity * i + Arity; the
+	// array is 64-byte aligned and shifted by Arity - 1 slots so that every
+	// group of siblings starts on a cache line boundary
+	template <typename T, typename Comp = std::less<T>, size_t Arity = 2>
 
 	class priority_queue
 	{
+		static_assert(Arity >= 2, "priority_queue needs at least two children per node");
+
 	protected:
 		T *mData;
 		size_t mCap;
 		size_t mSize;
 		Comp mLess;
 
+		static const size_t ALIGNMENT = 64;
+
+		// children are picked with a branch-free max/min reduction when the
+		// comparison is the plain < or > of an arithmetic type
+		static const bool SIMD_SELECT = std::is_arithmetic<T>::value &&
+										(std::is_same<Comp, std::less<T>>::value || std::is_same<Comp, std::greater<T>>::value);
+
+		static T *allocate(size_t capacity)
+		{
+			size_t n = capacity + Arity - 1;
+			T *raw = static_cast<T *>(::operator new[](n * sizeof(T), std::align_val_t(ALIGNMENT)));
+			for (size_t i = 0; i < n; i++)
+			{
+				new (raw + i) T();
+			}
+			return raw + (Arity - 1);
+		}
+
+		static void deallocate(T *data, size_t capacity)
+		{
+			T *raw = data - (Arity - 1);
+			size_t n = capacity + Arity - 1;
+			for (size_t i = 0; i < n; i++)
+			{
+				raw[i].~T();
+			}
+			::operator delete[](raw, std::align_val_t(ALIGNMENT));
+		}
+
 		void expand(size_t capacity)
 		{
-			T *arr = new T[capacity]();
+			T *arr = allocate(capacity);
 			for (size_t i = 0; i < mSize; i++)
 			{
 				arr[i] = mData[i];
 			}
-			delete[] mData;
+			deallocate(mData, mCap);
 			mData = arr;
 			mCap = capacity;
 		}
 
+		static size_t parent(size_t idx)
+		{
+			return (idx - 1) / Arity;
+		}
+
+		static size_t first_child(size_t idx)
+		{
+			return Arity * idx + 1;
+		}
+
+		static int level_of(size_t idx)
+		{
+			int l = 0;
+			while (idx > 0)
+			{
+				idx = parent(idx);
+				l++;
+			}
+			return l;
+		}
+
+		// index of the largest child in [c, end)
+		size_t best_child(size_t c, size_t end) const
+		{
+			if constexpr (SIMD_SELECT)
+			{
+				if (end - c == Arity)
+				{
+					const T *kids = mData + c;
+					T best = kids[0];
+					for (size_t i = 1; i < Arity; i++)
+					{
+						best = mLess(best, kids[i]) ? kids[i] : best;
+					}
+					size_t i = 0;
+					while (i + 1 < Arity && kids[i] != best)
+						i++;
+					return c + i;
+				}
+			}
+			size_t b = c;
+			for (size_t i = c + 1; i < end; i++)
+			{
+				if (mLess(mData[b], mData[i]))
+					b = i;
+			}
+			return b;
+		}
+
+		// orders heap positions by the values stored there
+		class index_less
+		{
+		protected:
+			const T *mData;
+			Comp mLess;
+
+		public:
+			index_less() : mData(nullptr), mLess() {}
+
+			index_less(const T *data, const Comp &c) : mData(data), mLess(c) {}
+
+			bool operator()(size_t a, size_t b) const
+			{
+				return mLess(mData[a], mData[b]);
+			}
+		};
+
+		// depth-first search that skips every subtree whose root is already
+		// smaller than k; returns any matching position when any is set,
+		// otherwise the last one in array order, or mSize when k is absent
+		size_t find_pos(const T &k, bool any) const
+		{
+			size_t pos = mSize;
+			if (mSize == 0)
+				return pos;
+			std::vector<size_t> stack(1, 0);
+			while (!stack.empty())
+			{
+				size_t i = stack.back();
+				stack.pop_back();
+				if (mData[i] == k)
+				{
+					if (any)
+						return i;
+					if (pos == mSize || i > pos)
+						pos = i;
+				}
+				size_t c = first_child(i);
+				for (size_t j = c; j < c + Arity && j < mSize; j++)
+				{
+					if (!mLess(mData[j], k))
+						stack.push_back(j);
+				}
+			}
+			return pos;
+		}
+
+		// copies [first, last) behind the current elements without sifting
+		template <typename InputIt>
+		void append(InputIt first, InputIt last)
+		{
+			if constexpr (std::is_base_of<std::forward_iterator_tag,
+										  typename std::iterator_traits<InputIt>::iterator_category>::value)
+			{
+				reserve(mSize + std::distance(first, last));
+			}
+			for (; first != last; ++first)
+			{
+				if (mSize + 1 > mCap)
+					expand(mCap * 2);
+				mData[mSize++] = *first;
+			}
+		}
+
+		// Floyd's bottom-up construction: fixDown every internal node, last first
+		void heapify()
+		{
+			if (mSize < 2)
+				return;
+			for (size_t i = parent(mSize - 1) + 1; i > 0; i--)
+			{
+				fixDown(i - 1);
+			}
+		}
+
 		void fixUp(size_t idx)
 		{
 			T tmp = mData[idx];
 			while (idx > 0)
 			{
-				size_t p = (idx - 1) / 2;
+				size_t p = parent(idx);
 				if (mLess(tmp, mData[p]))
 					break;
 				mData[idx] = mData[p];
@@ -48,10 +212,10 @@ namespace CP
 		{
 			T tmp = mData[idx];
 			size_t c;
-			while ((c = 2 * idx + 1) < mSize)
+			while ((c = first_child(idx)) < mSize)
 			{
-				if (c + 1 < mSize && mLess(mData[c], mData[c + 1]))
-					c++;
+				size_t end = c + Arity < mSize ? c + Arity : mSize;
+				c = best_child(c, end);
 				if (mLess(mData[c], tmp))
 					break;
 				mData[idx] = mData[c];
@@ -71,7 +235,7 @@ namespace CP
 		//-------------- constructor ----------
 
 		// copy constructor
-		priority_queue(const priority_queue<T, Comp> &a) : mData(new T[a.mCap]()), mCap(a.mCap), mSize(a.mSize), mLess(a.mLess)
+		priority_queue(const priority_queue<T, Comp, Arity> &a) : mData(allocate(a.mCap)), mCap(a.mCap), mSize(a.mSize), mLess(a.mLess)
 		{
 			for (size_t i = 0; i < a.mCap; i++)
 			{
@@ -80,12 +244,19 @@ namespace CP
 		}
 
 		// default constructor
-		priority_queue(const Comp &c = Comp()) : mData(new T[1]()), mCap(1), mSize(0), mLess(c)
+		priority_queue(const Comp &c = Comp()) : mData(allocate(1)), mCap(1), mSize(0), mLess(c)
+		{
+		}
+
+		// range constructor, O(n) bottom-up heap construction
+		template <typename InputIt>
+		priority_queue(InputIt first, InputIt last, const Comp &c = Comp()) : mData(allocate(1)), mCap(1), mSize(0), mLess(c)
 		{
+			assign(first, last);
 		}
 
 		// copy assignment operator
-		priority_queue<T, Comp> &operator=(priority_queue<T, Comp> other)
+		priority_queue<T, Comp, Arity> &operator=(priority_queue<T, Comp, Arity> other)
 		{
 			using std::swap;
 			swap(mSize, other.mSize);
@@ -97,7 +268,7 @@ namespace CP
 
 		~priority_queue()
 		{
-			delete[] mData;
+			deallocate(mData, mCap);
 		}
 
 		//------------- capacity function -------------------
@@ -111,6 +282,17 @@ namespace CP
 			return mSize;
 		}
 
+		size_t capacity() const
+		{
+			return mCap;
+		}
+
+		void reserve(size_t n)
+		{
+			if (n > mCap)
+				expand(n);
+		}
+
 		//----------------- access -----------------
 		const T &top()
 		{
@@ -138,6 +320,34 @@ namespace CP
 			fixDown(0);
 		}
 
+		// replaces the content, O(n)
+		template <typename InputIt>
+		void assign(InputIt first, InputIt last)
+		{
+			mSize = 0;
+			append(first, last);
+			heapify();
+		}
+
+		// adds a batch; small batches are sifted up one by one, large ones
+		// (m log n > n) rebuild the whole heap in O(n + m) instead
+		template <typename InputIt>
+		void push_range(InputIt first, InputIt last)
+		{
+			size_t old = mSize;
+			append(first, last);
+			size_t m = mSize - old;
+			if (m == 0)
+				return;
+			if (m * (size_t)(level_of(mSize - 1) + 1) > mSize)
+				heapify();
+			else
+			{
+				for (size_t i = old; i < mSize; i++)
+					fixUp(i);
+			}
+		}
+
 		//-------------- extra (unlike STL) ------------------
 		void erase(const T &v)
 		{
@@ -163,42 +373,28 @@ namespace CP
 		{
 			if (this->mSize == 0)
 				return -1;
-			return (int)log2(this->mSize);
+			return level_of(this->mSize - 1);
 		}
 
 		bool find(T k) const
 		{
-			for (int i = 0; i < mSize; ++i)
-			{
-				if (mData[i] == k)
-				{
-					return true;
-				}
-			}
-			return false;
+			return find_pos(k, true) != mSize;
 		}
 
 		int find_level(T k) const
 		{
-			if (!find(k))
+			size_t pos = find_pos(k, false);
+			if (pos == mSize)
 				return -1;
-			int pos;
-			for (int i = 0; i < mSize; ++i)
-			{
-				if (mData[i] == k)
-				{
-					pos = i;
-				}
-			}
-			return (int)log2(pos + 1);
+			return level_of(pos);
 		}
 
-		bool operator==(const CP::priority_queue<T, Comp> &other) const
+		bool operator==(const CP::priority_queue<T, Comp, Arity> &other) const
 		{
 			if (mSize != other.mSize)
 				return false;
-			CP::priority_queue<T, Comp> pq1 = *this;
-			CP::priority_queue<T, Comp> pq2 = other;
+			CP::priority_queue<T, Comp, Arity> pq1 = *this;
+			CP::priority_queue<T, Comp, Arity> pq2 = other;
 			while (pq1.empty() == false)
 			{
 				if (pq1.top() != pq2.top())
@@ -209,50 +405,6 @@ namespace CP
 			return true;
 		}
 
-		void K_AryfixUp(size_t idx)
-		{
-			T tem = mData[idx];
-			int c;
-			while (idx > 0)
-			{
-				c = (idx - 1) / 4;
-				if (mLess(mData[c], tem))
-					mData[idx] = mData[c];
-				else
-					break;
-				idx = c;
-			}
-			mData[idx] = tem;
-		}
-
-		void K_AryfixDown(size_t idx)
-		{
-			T tem = mData[idx];
-			int c;
-			while ((c = (idx * 4) + 1) < mSize)
-			{
-				int p = 0;
-				for (int i = 1; i <= 3; ++i)
-				{
-					if (c + i < mSize)
-					{
-						if (mLess(mData[c + p], mData[c + i]))
-						{
-							p = i;
-						}
-					}
-				}
-				if (c + p < mSize && mLess(tem, mData[c + p]))
-				{
-					mData[idx] = mData[c + p];
-				}
-				else
-					break;
-				idx = c + p;
-			}
-			mData[idx] = tem;
-		}
-
 		void change_value(size_t pos, const T &value)
 		{
 			mData[pos] = value;
@@ -262,35 +414,81 @@ namespace CP
 
 		size_t get_rank(size_t pos) const
 		{
-			int c = 0;
-			T a = mData[pos];
-			for (int i = 0; i < mSize; ++i)
+			return count_above(mData[pos]);
+		}
+
+		// number of elements strictly greater than x, in O(answer * Arity)
+		// a node that is not greater than x cuts off its whole subtree
+		size_t count_above(const T &x) const
+		{
+			if (mSize == 0 || !mLess(x, mData[0]))
+				return 0;
+			size_t c = 0;
+			std::vector<size_t> stack(1, 0);
+			while (!stack.empty())
 			{
-				if (mLess(a, mData[i]))
-					++c;
+				size_t i = stack.back();
+				stack.pop_back();
+				c++;
+				size_t first = first_child(i);
+				for (size_t j = first; j < first + Arity && j < mSize; j++)
+				{
+					if (mLess(x, mData[j]))
+						stack.push_back(j);
+				}
 			}
 			return c;
 		}
 
+		// k-th largest element (k = 1 is top()), O(k log k)
 		T get_kth(size_t k) const
 		{
-			std::vector<T> v;
-			for (int i = 0; i < 7; ++i)
+			if (k == 0 || k > mSize)
+				throw std::out_of_range("index of out range");
+			return top_k(k).back();
+		}
+
+		// the k largest elements in order, best first, O(k log k)
+		// grows a best-first frontier from the root: only children of
+		// elements already taken can be next
+		std::vector<T> top_k(size_t k) const
+		{
+			std::vector<T> r;
+			if (k > mSize)
+				k = mSize;
+			if (k == 0)
+				return r;
+			r.reserve(k);
+			CP::priority_queue<size_t, index_less> frontier(index_less(mData, mLess));
+			frontier.reserve(k * (Arity - 1) + 1);
+			frontier.push(0);
+			while (r.size() < k)
 			{
-				if (i < mSize)
-					v.push_back(mData[i]);
+				size_t i = frontier.top();
+				frontier.pop();
+				r.push_back(mData[i]);
+				size_t first = first_child(i);
+				for (size_t j = first; j < first + Arity && j < mSize; j++)
+				{
+					frontier.push(j);
+				}
 			}
-			sort(v.begin(), v.end(), mLess);
-			return v[v.size() - k];
+			return r;
 		}
 
 		std::vector<T> at_level(size_t k) const
 		{
+			// level k is the contiguous range [first, first + Arity^k)
 			std::vector<T> r;
-			for (int i = 0; i < mSize; ++i)
+			size_t first = 0, width = 1;
+			for (size_t l = 0; l < k && first < mSize; l++)
+			{
+				first = first * Arity + 1;
+				width *= Arity;
+			}
+			for (size_t i = first; i < first + width && i < mSize; ++i)
 			{
-				if ((int)log2(i + 1) == k)
-					r.push_back(mData[i]);
+				r.push_back(mData[i]);
 			}
 			sort(r.rbegin(), r.rend(), mLess);
 			return r;
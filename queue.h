@@ -3,6 +3,8 @@
 
 #include <stdexcept>
 #include <iostream>
+#include <memory>
+#include <unordered_map>
 //#pragma once
 
 namespace CP
@@ -17,6 +19,64 @@ namespace CP
 		size_t mSize;
 		size_t mFront;
 
+		// frequency index behind enable_counting(); only that function names
+		// the hash table, so a queue of a type without std::hash still works
+		class count_index
+		{
+		public:
+			virtual ~count_index() {}
+			virtual void add(const T &x) = 0;
+			virtual void remove(const T &x) = 0;
+			virtual size_t count(const T &x) const = 0;
+			virtual size_t distinct() const = 0;
+			virtual count_index *clone() const = 0;
+		};
+
+		class hash_count_index : public count_index
+		{
+		protected:
+			std::unordered_map<T, size_t> mTable;
+
+		public:
+			explicit hash_count_index(size_t n)
+			{
+				mTable.reserve(n);
+			}
+
+			void add(const T &x) { ++mTable[x]; }
+
+			void remove(const T &x)
+			{
+				auto it = mTable.find(x);
+				if (--it->second == 0)
+					mTable.erase(it);
+			}
+
+			size_t count(const T &x) const
+			{
+				auto it = mTable.find(x);
+				return it == mTable.end() ? 0 : it->second;
+			}
+
+			size_t distinct() const { return mTable.size(); }
+
+			count_index *clone() const { return new hash_count_index(*this); }
+		};
+
+		std::unique_ptr<count_index> mCount; // nullptr unless counting
+
+		void count_add(const T &element)
+		{
+			if (mCount)
+				mCount->add(element);
+		}
+
+		void count_remove(const T &element)
+		{
+			if (mCount)
+				mCount->remove(element);
+		}
+
 		void expand(size_t capacity)
 		{
 			T *arr = new T[capacity]();
@@ -44,7 +104,7 @@ namespace CP
 
 		// copy constructor
 		queue(const queue<T> &a) : mData(new T[a.mCap]()), mCap(a.mCap),
-								   mSize(a.mSize), mFront(a.mFront)
+								   mSize(a.mSize), mFront(a.mFront), mCount(a.mCount ? a.mCount->clone() : nullptr)
 		{
 			for (size_t i = 0; i < a.mCap; i++)
 			{
@@ -63,6 +123,7 @@ namespace CP
 			swap(mCap, other.mCap);
 			swap(mData, other.mData);
 			swap(mFront, other.mFront);
+			swap(mCount, other.mCount);
 			return *this;
 		}
 
@@ -102,12 +163,14 @@ namespace CP
 			ensureCapacity(mSize + 1);
 			mData[(mFront + mSize) % mCap] = element;
 			mSize++;
+			count_add(element);
 		}
 
 		void pop()
 		{
 			if (size() == 0)
 				throw std::out_of_range("index of out range");
+			count_remove(mData[mFront]);
 			mFront = (mFront + 1) % mCap;
 			mSize--;
 		}
@@ -146,8 +209,16 @@ namespace CP
 
 		std::vector<std::pair<T, size_t>> count_multi(std::vector<T> & k) const
 		{
-			std::map<T, int> m;
 			std::vector<std::pair<T, size_t>> vp;
+			if (mCount)
+			{
+				for (auto &x : k)
+				{
+					vp.push_back(std::make_pair(x, count(x)));
+				}
+				return vp;
+			}
+			std::map<T, int> m;
 			for (int i = 0; i < mSize; ++i)
 			{
 				++m[mData[(mFront + i) % mCap]];
@@ -178,6 +249,7 @@ namespace CP
 			}
 			for (int e = s.mSize - 1; e >= 0; --e)
 			{
+				count_add(s.mData[e]);
 				arr[j++] = s.mData[e];
 			}
 			delete[] mData;
@@ -198,6 +270,7 @@ namespace CP
 			}
 			for (int i = 0; i < q.mSize; i++)
 			{
+				count_add(q.mData[i]);
 				arr[j++] = q.mData[i];
 			}
 
@@ -283,6 +356,56 @@ namespace CP
 				++e;
 			}
 		}
+
+		// keep a frequency table in sync with every mutator so that count(),
+		// distinct() and count_multi() no longer scan the queue
+		// T needs std::hash and operator== from here on
+		void enable_counting()
+		{
+			if (mCount)
+				return;
+			std::unique_ptr<count_index> index(new hash_count_index(mSize));
+			for (size_t i = 0; i < mSize; ++i)
+			{
+				index->add(mData[(mFront + i) % mCap]);
+			}
+			mCount = std::move(index);
+		}
+
+		void disable_counting()
+		{
+			mCount.reset();
+		}
+
+		bool counting() const
+		{
+			return mCount != nullptr;
+		}
+
+		size_t count(const T &x) const
+		{
+			if (mCount)
+				return mCount->count(x);
+			size_t c = 0;
+			for (size_t i = 0; i < mSize; ++i)
+			{
+				if (mData[(mFront + i) % mCap] == x)
+					++c;
+			}
+			return c;
+		}
+
+		size_t distinct() const
+		{
+			if (mCount)
+				return mCount->distinct();
+			std::unordered_map<T, size_t> m;
+			for (size_t i = 0; i < mSize; ++i)
+			{
+				++m[mData[(mFront + i) % mCap]];
+			}
+			return m.size();
+		}
 	};
 }
 
@@ -0,0 +1,147 @@
+#ifndef _CP_RADIX_HEAP_INCLUDED_
+#define _CP_RADIX_HEAP_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <utility>
+#include <limits>
+#include <type_traits>
+//#pragma once
+
+namespace CP
+{
+
+	// monotone min-heap for unsigned integer keys
+	// a key may never be smaller than the current top(), which is what
+	// Dijkstra and discrete event simulation need. An entry lives in the
+	// bucket numbered by the highest bit where its key differs from mLast, so
+	// push is O(1) and every entry moves to a lower bucket at most
+	// log(C) times before it is popped. Buckets are plain arrays scanned
+	// sequentially
+	template <typename Key, typename Value>
+	class radix_heap
+	{
+		static_assert(std::is_unsigned<Key>::value, "radix_heap needs an unsigned integer key");
+
+	public:
+		typedef std::pair<Key, Value> ValueT;
+
+	protected:
+		static const size_t BITS = std::numeric_limits<Key>::digits;
+
+		std::vector<ValueT> mBuckets[BITS + 1]; // bucket 0 holds keys equal to mLast
+		Key mLast;
+		size_t mSize;
+
+		static size_t bit_width(Key x)
+		{
+			if (x == 0)
+				return 0;
+#if defined(__GNUC__) || defined(__clang__)
+			return 64 - __builtin_clzll((unsigned long long)x);
+#else
+			size_t n = 0;
+			while (x != 0)
+			{
+				x >>= 1;
+				n++;
+			}
+			return n;
+#endif
+		}
+
+		size_t bucket_of(Key k) const
+		{
+			return bit_width(k ^ mLast);
+		}
+
+		// makes bucket 0 non-empty: the smallest key of the first non-empty
+		// bucket becomes mLast and that bucket is spread over lower buckets
+		void pull()
+		{
+			if (!mBuckets[0].empty())
+				return;
+			size_t i = 1;
+			while (mBuckets[i].empty())
+				i++;
+			std::vector<ValueT> &b = mBuckets[i];
+			Key m = b[0].first;
+			for (size_t j = 1; j < b.size(); j++)
+			{
+				if (b[j].first < m)
+					m = b[j].first;
+			}
+			mLast = m;
+			for (auto &e : b)
+			{
+				mBuckets[bucket_of(e.first)].push_back(std::move(e));
+			}
+			b.clear();
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// default constructor
+		radix_heap() : mLast(0), mSize(0) {}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		//----------------- access -----------------
+		const ValueT &top()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			pull();
+			return mBuckets[0].back();
+		}
+
+		Key top_key()
+		{
+			return top().first;
+		}
+
+		const Value &top_value()
+		{
+			return top().second;
+		}
+
+		//----------------- modifier -------------
+		void push(Key key, const Value &value)
+		{
+			if (key < mLast)
+				throw std::invalid_argument("radix_heap key is smaller than the current minimum");
+			mBuckets[bucket_of(key)].push_back(std::make_pair(key, value));
+			mSize++;
+		}
+
+		void pop()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			pull();
+			mBuckets[0].pop_back();
+			mSize--;
+		}
+
+		void clear()
+		{
+			for (auto &b : mBuckets)
+				b.clear();
+			mLast = 0;
+			mSize = 0;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef _CP_SCRATCH_FILE_INCLUDED_
+#define _CP_SCRATCH_FILE_INCLUDED_
+
+#include <cstdio>
+#include <string>
+#include <atomic>
+#if defined(_WIN32)
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
+//#pragma once
+
+namespace CP
+{
+
+	// helpers for the temporary files of the disk-backed containers
+
+	// path of a new scratch file in dir, e.g. dir/run_4242_7.run; the pid
+	// keeps processes sharing dir apart and the counter every file of this one
+	inline std::string scratch_path(const std::string &dir, const std::string &prefix, const std::string &ext)
+	{
+		static std::atomic<unsigned long long> next(0);
+#if defined(_WIN32)
+		unsigned long long pid = (unsigned long long)_getpid();
+#else
+		unsigned long long pid = (unsigned long long)getpid();
+#endif
+		return dir + "/" + prefix + "_" + std::to_string(pid) + "_" + std::to_string(next++) + ext;
+	}
+
+	// tells the kernel f is read front to back, so it reads ahead further
+	inline void advise_sequential(FILE *f)
+	{
+#if defined(__linux__)
+		posix_fadvise(fileno(f), 0, 0, POSIX_FADV_SEQUENTIAL);
+#else
+		(void)f;
+#endif
+	}
+}
+
+#endif
@@ -0,0 +1,227 @@
+#ifndef _CP_SEQUENCE_HEAP_INCLUDED_
+#define _CP_SEQUENCE_HEAP_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include "priority_queue.h"
+//#pragma once
+
+namespace CP
+{
+
+	// priority queue for data far larger than the cache (Sanders' sequence heap)
+	// same ordering as CP::priority_queue: top() is the largest under Comp.
+	// New elements go to a small insertion heap. When it is full it is sorted,
+	// merged with the deletion buffer and stored as a sorted run; group g
+	// holds up to k runs and a full group is k-way merged into one run of
+	// group g + 1. pop() is served from the deletion buffer, refilled from
+	// the ends of the runs, so apart from the two small buffers every access
+	// is a sequential scan of a run
+	template <typename T, typename Comp = std::less<T>>
+	class sequence_heap
+	{
+	protected:
+		typedef std::vector<T> run; // ascending, the best element at the back
+
+		// orders runs by their best remaining element
+		class run_less
+		{
+		protected:
+			const std::vector<run *> *mRuns;
+			Comp mLess;
+
+		public:
+			run_less() : mRuns(nullptr), mLess() {}
+
+			run_less(const std::vector<run *> *runs, const Comp &c) : mRuns(runs), mLess(c) {}
+
+			bool operator()(size_t a, size_t b) const
+			{
+				return mLess((*mRuns)[a]->back(), (*mRuns)[b]->back());
+			}
+		};
+
+		CP::priority_queue<T, Comp> mInsert;
+		run mDelete; // ascending, never worse than any element of a run
+		std::vector<std::vector<run>> mGroups;
+		size_t mInsertCap;
+		size_t mK;
+		size_t mSize;
+		Comp mLess;
+
+		// k-way merge of several ascending runs into one
+		run merge_runs(std::vector<run *> &runs)
+		{
+			size_t total = 0;
+			for (run *r : runs)
+				total += r->size();
+			run out(total);
+			CP::priority_queue<size_t, run_less> heads(run_less(&runs, mLess));
+			for (size_t i = 0; i < runs.size(); i++)
+			{
+				if (!runs[i]->empty())
+					heads.push(i);
+			}
+			// fill from the back so the result stays ascending
+			for (size_t pos = total; pos > 0; pos--)
+			{
+				size_t i = heads.top();
+				heads.pop();
+				out[pos - 1] = std::move(runs[i]->back());
+				runs[i]->pop_back();
+				if (!runs[i]->empty())
+					heads.push(i);
+			}
+			return out;
+		}
+
+		void add_run(size_t g, run &&r)
+		{
+			if (mGroups.size() <= g)
+				mGroups.resize(g + 1);
+			if (mGroups[g].size() >= mK)
+			{
+				std::vector<run *> runs;
+				for (run &x : mGroups[g])
+					runs.push_back(&x);
+				run merged = merge_runs(runs);
+				mGroups[g].clear();
+				add_run(g + 1, std::move(merged));
+			}
+			mGroups[g].push_back(std::move(r));
+		}
+
+		// the insertion heap becomes a run; its best elements may displace
+		// part of the deletion buffer, which keeps its size
+		void flush()
+		{
+			run ins(mInsert.size());
+			for (size_t i = 0; i < ins.size(); i++)
+			{
+				ins[i] = mInsert.top();
+				mInsert.pop();
+			}
+			std::reverse(ins.begin(), ins.end());
+			run merged(ins.size() + mDelete.size());
+			std::merge(std::make_move_iterator(ins.begin()), std::make_move_iterator(ins.end()),
+					   std::make_move_iterator(mDelete.begin()), std::make_move_iterator(mDelete.end()),
+					   merged.begin(), mLess);
+			size_t keep = mDelete.size();
+			mDelete.assign(std::make_move_iterator(merged.end() - keep), std::make_move_iterator(merged.end()));
+			merged.resize(merged.size() - keep);
+			if (!merged.empty())
+				add_run(0, std::move(merged));
+		}
+
+		// takes the best mInsertCap elements over all runs
+		void refill()
+		{
+			std::vector<run *> runs;
+			for (auto &g : mGroups)
+			{
+				for (run &r : g)
+				{
+					if (!r.empty())
+						runs.push_back(&r);
+				}
+			}
+			if (runs.empty())
+				return;
+			CP::priority_queue<size_t, run_less> heads(run_less(&runs, mLess));
+			for (size_t i = 0; i < runs.size(); i++)
+				heads.push(i);
+			mDelete.clear();
+			while (mDelete.size() < mInsertCap && !heads.empty())
+			{
+				size_t i = heads.top();
+				heads.pop();
+				mDelete.push_back(std::move(runs[i]->back()));
+				runs[i]->pop_back();
+				if (!runs[i]->empty())
+					heads.push(i);
+			}
+			std::reverse(mDelete.begin(), mDelete.end());
+			for (auto &g : mGroups)
+			{
+				g.erase(std::remove_if(g.begin(), g.end(), [](const run &r)
+									   { return r.empty(); }),
+						g.end());
+			}
+		}
+
+		// true when the insertion heap holds the overall best element
+		bool top_in_insert()
+		{
+			if (mDelete.empty())
+				refill();
+			if (mInsert.empty())
+				return false;
+			return mDelete.empty() || mLess(mDelete.back(), mInsert.top());
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// insert is the size of the insertion heap and of the deletion buffer,
+		// k the number of runs per group
+		sequence_heap(size_t insert = 1024, size_t k = 16, const Comp &c = Comp())
+			: mInsert(c), mInsertCap(std::max<size_t>(1, insert)), mK(std::max<size_t>(2, k)), mSize(0), mLess(c)
+		{
+			mInsert.reserve(mInsertCap);
+			mDelete.reserve(mInsertCap);
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		//----------------- access -----------------
+		const T &top()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return top_in_insert() ? mInsert.top() : mDelete.back();
+		}
+
+		//----------------- modifier -------------
+		void push(const T &element)
+		{
+			if (mInsert.size() >= mInsertCap)
+				flush();
+			mInsert.push(element);
+			mSize++;
+		}
+
+		void pop()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			if (top_in_insert())
+				mInsert.pop();
+			else
+				mDelete.pop_back();
+			mSize--;
+		}
+
+		void clear()
+		{
+			mInsert = CP::priority_queue<T, Comp>(mLess);
+			mDelete.clear();
+			mGroups.clear();
+			mSize = 0;
+		}
+	};
+}
+
+#endif
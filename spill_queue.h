@@ -0,0 +1,232 @@
+#ifndef _CP_SPILL_QUEUE_INCLUDED_
+#define _CP_SPILL_QUEUE_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <cstdio>
+#include <deque>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <type_traits>
+#include "scratch_file.h"
+//#pragma once
+
+namespace CP
+{
+
+	// FIFO queue with a fixed memory budget
+	// the oldest elements sit in an in-memory head buffer and the newest in an
+	// in-memory tail buffer; whenever the tail fills up while older elements
+	// are still waiting it is appended to a segment file on disk. Segments are
+	// read back sequentially in large chunks and deleted once consumed.
+	// T must be trivially copyable since it is written to disk byte for byte
+	template <typename T>
+	class spill_queue
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "spill_queue needs a trivially copyable T");
+
+	protected:
+		struct segment
+		{
+			std::string path;
+			size_t written;
+			size_t read;
+		};
+
+		std::string mDir;
+		size_t mBufCap; // elements per in-memory buffer
+		size_t mSegCap; // elements per segment file
+		std::vector<T> mHead; // oldest elements, consumed from mHeadPos
+		size_t mHeadPos;
+		std::vector<T> mTail; // newest elements
+		std::deque<segment> mSegments; // everything in between, oldest first
+		FILE *mWriter; // open on mSegments.back() while it has room
+		FILE *mReader; // open on mSegments.front()
+		size_t mSize;
+
+		std::string segment_path()
+		{
+			return scratch_path(mDir, "spill", ".seg");
+		}
+
+		void spill_tail()
+		{
+			size_t done = 0;
+			while (done < mTail.size())
+			{
+				if (mWriter == nullptr)
+				{
+					segment s;
+					s.path = segment_path();
+					s.written = 0;
+					s.read = 0;
+					mWriter = std::fopen(s.path.c_str(), "wb");
+					if (mWriter == nullptr)
+						throw std::runtime_error("cannot create spill segment " + s.path);
+					mSegments.push_back(s);
+				}
+				segment &s = mSegments.back();
+				size_t n = mTail.size() - done;
+				if (n > mSegCap - s.written)
+					n = mSegCap - s.written;
+				if (std::fwrite(mTail.data() + done, sizeof(T), n, mWriter) != n)
+					throw std::runtime_error("cannot write spill segment " + s.path);
+				s.written += n;
+				done += n;
+				if (s.written == mSegCap)
+				{
+					// sealed, no more appends to this segment
+					std::fclose(mWriter);
+					mWriter = nullptr;
+				}
+			}
+			mTail.clear();
+		}
+
+		void drop_front_segment()
+		{
+			if (mReader != nullptr)
+			{
+				std::fclose(mReader);
+				mReader = nullptr;
+			}
+			if (mSegments.size() == 1 && mWriter != nullptr)
+			{
+				std::fclose(mWriter);
+				mWriter = nullptr;
+			}
+			std::remove(mSegments.front().path.c_str());
+			mSegments.pop_front();
+		}
+
+		void refill_head()
+		{
+			mHead.clear();
+			mHeadPos = 0;
+			if (mSegments.empty())
+			{
+				// nothing on disk, the tail is next in line
+				mHead.swap(mTail);
+				return;
+			}
+			segment &s = mSegments.front();
+			if (mSegments.size() == 1 && mWriter != nullptr)
+				std::fflush(mWriter);
+			if (mReader == nullptr)
+			{
+				mReader = std::fopen(s.path.c_str(), "rb");
+				if (mReader == nullptr)
+					throw std::runtime_error("cannot open spill segment " + s.path);
+				advise_sequential(mReader);
+			}
+			size_t n = s.written - s.read;
+			if (n > mBufCap)
+				n = mBufCap;
+			mHead.resize(n);
+			if (std::fread(mHead.data(), sizeof(T), n, mReader) != n)
+				throw std::runtime_error("cannot read spill segment " + s.path);
+			s.read += n;
+			// a fully consumed segment is deleted; if it was still being written
+			// the writer is closed too and the next spill starts a fresh file
+			if (s.read == s.written)
+				drop_front_segment();
+		}
+
+		void ensure_head()
+		{
+			if (mHeadPos == mHead.size())
+				refill_head();
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// buffer is the number of elements kept in each in-memory buffer,
+		// segment the number of elements per file on disk
+		spill_queue(const std::string &dir, size_t buffer = 1 << 16, size_t segment = 1 << 22)
+			: mDir(dir), mBufCap(buffer == 0 ? 1 : buffer), mSegCap(segment == 0 ? 1 : segment),
+			  mHeadPos(0), mWriter(nullptr), mReader(nullptr), mSize(0)
+		{
+			std::filesystem::create_directories(mDir);
+			mHead.reserve(mBufCap);
+			mTail.reserve(mBufCap);
+		}
+
+		spill_queue(const spill_queue<T> &) = delete;
+		spill_queue<T> &operator=(const spill_queue<T> &) = delete;
+
+		~spill_queue()
+		{
+			clear();
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		// number of elements currently on disk
+		size_t spilled() const
+		{
+			size_t n = 0;
+			for (auto &s : mSegments)
+				n += s.written - s.read;
+			return n;
+		}
+
+		//----------------- access -----------------
+		const T &front()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			ensure_head();
+			return mHead[mHeadPos];
+		}
+
+		//----------------- modifier -------------
+		void push(const T &element)
+		{
+			mTail.push_back(element);
+			mSize++;
+			if (mTail.size() >= mBufCap)
+			{
+				if (mSegments.empty() && mHeadPos == mHead.size())
+				{
+					mHead.clear();
+					mHeadPos = 0;
+					mHead.swap(mTail);
+				}
+				else
+					spill_tail();
+			}
+		}
+
+		void pop()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			ensure_head();
+			mHeadPos++;
+			mSize--;
+		}
+
+		void clear()
+		{
+			while (!mSegments.empty())
+				drop_front_segment();
+			mHead.clear();
+			mHeadPos = 0;
+			mTail.clear();
+			mSize = 0;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,320 @@
+#ifndef _CP_TASK_SCHEDULER_INCLUDED_
+#define _CP_TASK_SCHEDULER_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <vector>
+#include <exception>
+#include "work_stealing_deque.h"
+#include "mpmc_queue.h"
+//#pragma once
+
+namespace CP
+{
+
+	// work-stealing task scheduler
+	// every worker owns a CP::work_stealing_deque, runs its own tasks LIFO and
+	// steals FIFO from a random victim when it runs dry. Tasks submitted from
+	// outside the pool go through a shared CP::mpmc_queue. An exception
+	// from a task is handed to its group's wait(); a spawned task has no
+	// one to report to, so its exception is dropped
+	class task_scheduler
+	{
+	public:
+		class task_group;
+
+	protected:
+		struct task
+		{
+			std::function<void()> fn;
+			task_group *group;
+
+			task(std::function<void()> fn, task_group *group) : fn(std::move(fn)), group(group) {}
+		};
+
+		struct worker
+		{
+			work_stealing_deque<task *> deque;
+			unsigned long long seed;
+		};
+
+		std::vector<worker *> mWorkers;
+		std::vector<std::thread> mThreads;
+		mpmc_queue<task *> mInjected;
+		std::atomic<bool> mStop;
+		std::atomic<size_t> mSleeping;
+		std::mutex mLock;
+		std::condition_variable mWake;
+
+		static task_scheduler *&current_scheduler()
+		{
+			static thread_local task_scheduler *s = nullptr;
+			return s;
+		}
+
+		static int &current_index()
+		{
+			static thread_local int idx = -1;
+			return idx;
+		}
+
+		int self() const
+		{
+			return current_scheduler() == this ? current_index() : -1;
+		}
+
+		static unsigned long long next_random(unsigned long long &s)
+		{
+			// xorshift64
+			s ^= s << 13;
+			s ^= s >> 7;
+			s ^= s << 17;
+			return s;
+		}
+
+		void submit(task *t)
+		{
+			int me = self();
+			if (me >= 0)
+				mWorkers[me]->deque.push(t);
+			else
+				mInjected.push(t);
+			if (mSleeping.load(std::memory_order_seq_cst) > 0)
+			{
+				std::lock_guard<std::mutex> lk(mLock);
+				mWake.notify_one();
+			}
+		}
+
+		task *find_task(int me)
+		{
+			task *t = nullptr;
+			if (me >= 0 && mWorkers[me]->deque.pop(t))
+				return t;
+			if (mInjected.try_pop(t))
+				return t;
+			size_t n = mWorkers.size();
+			unsigned long long seed;
+			if (me >= 0)
+				seed = next_random(mWorkers[me]->seed);
+			else
+			{
+				static thread_local unsigned long long s = 0x9e3779b97f4a7c15ull ^ (unsigned long long)std::hash<std::thread::id>()(std::this_thread::get_id());
+				seed = next_random(s);
+			}
+			// random victim first, then sweep the rest once
+			for (size_t i = 0; i < n; i++)
+			{
+				size_t v = (seed + i) % n;
+				if ((int)v != me && mWorkers[v]->deque.steal(t))
+					return t;
+			}
+			return nullptr;
+		}
+
+		static void execute(task *t)
+		{
+			try
+			{
+				t->fn();
+			}
+			catch (...)
+			{
+				if (t->group != nullptr)
+					t->group->fail(std::current_exception());
+			}
+			if (t->group != nullptr)
+				t->group->mPending.fetch_sub(1, std::memory_order_release);
+			delete t;
+		}
+
+		void run_worker(int me)
+		{
+			current_scheduler() = this;
+			current_index() = me;
+			int idle = 0;
+			while (!mStop.load(std::memory_order_acquire))
+			{
+				task *t = find_task(me);
+				if (t != nullptr)
+				{
+					execute(t);
+					idle = 0;
+					continue;
+				}
+				if (++idle < 64)
+				{
+					std::this_thread::yield();
+					continue;
+				}
+				// nothing to do for a while, park; the timeout covers a submit
+				// that raced with going to sleep
+				std::unique_lock<std::mutex> lk(mLock);
+				mSleeping.fetch_add(1, std::memory_order_seq_cst);
+				mWake.wait_for(lk, std::chrono::milliseconds(1));
+				mSleeping.fetch_sub(1, std::memory_order_relaxed);
+				idle = 0;
+			}
+			current_scheduler() = nullptr;
+			current_index() = -1;
+		}
+
+	public:
+		// a set of tasks that can be waited on together
+		// wait() executes other tasks instead of blocking, so fork/join nests
+		class task_group
+		{
+			friend class task_scheduler;
+
+		protected:
+			task_scheduler &mSched;
+			std::atomic<size_t> mPending;
+			std::mutex mLock;
+			std::exception_ptr mError; // first exception thrown by a task
+
+			// keeps the first exception, later ones are dropped
+			void fail(std::exception_ptr e)
+			{
+				std::lock_guard<std::mutex> lk(mLock);
+				if (!mError)
+					mError = e;
+			}
+
+			void drain()
+			{
+				while (mPending.load(std::memory_order_acquire) > 0)
+				{
+					task *t = mSched.find_task(mSched.self());
+					if (t != nullptr)
+						execute(t);
+					else
+						std::this_thread::yield();
+				}
+			}
+
+		public:
+			task_group(task_scheduler &s) : mSched(s), mPending(0) {}
+
+			task_group(const task_group &) = delete;
+			task_group &operator=(const task_group &) = delete;
+
+			// waits without throwing; an exception nobody waited for is lost
+			~task_group()
+			{
+				drain();
+			}
+
+			template <typename F>
+			void run(F f)
+			{
+				mPending.fetch_add(1, std::memory_order_relaxed);
+				mSched.submit(new task(std::function<void()>(std::move(f)), this));
+			}
+
+			// rethrows the first exception of the tasks run since the last wait
+			void wait()
+			{
+				drain();
+				std::exception_ptr e;
+				{
+					std::lock_guard<std::mutex> lk(mLock);
+					e = mError;
+					mError = nullptr;
+				}
+				if (e)
+					std::rethrow_exception(e);
+			}
+		};
+
+		//-------------- constructor ----------
+		task_scheduler(size_t threads = std::thread::hardware_concurrency()) : mInjected(4096), mStop(false), mSleeping(0)
+		{
+			if (threads == 0)
+				threads = 1;
+			for (size_t i = 0; i < threads; i++)
+			{
+				worker *w = new worker();
+				w->seed = 0x9e3779b97f4a7c15ull * (i + 1);
+				mWorkers.push_back(w);
+			}
+			for (size_t i = 0; i < threads; i++)
+			{
+				mThreads.emplace_back(&task_scheduler::run_worker, this, (int)i);
+			}
+		}
+
+		task_scheduler(const task_scheduler &) = delete;
+		task_scheduler &operator=(const task_scheduler &) = delete;
+
+		// tasks that are still queued when the scheduler is destroyed are dropped
+		~task_scheduler()
+		{
+			mStop.store(true, std::memory_order_release);
+			{
+				std::lock_guard<std::mutex> lk(mLock);
+				mWake.notify_all();
+			}
+			for (auto &t : mThreads)
+				t.join();
+			task *t;
+			for (worker *w : mWorkers)
+			{
+				while (w->deque.pop(t))
+					delete t;
+				delete w;
+			}
+			while (mInjected.try_pop(t))
+				delete t;
+		}
+
+		size_t size() const
+		{
+			return mWorkers.size();
+		}
+
+		//----------------- modifier -------------
+		// fire and forget
+		template <typename F>
+		void spawn(F f)
+		{
+			submit(new task(std::function<void()>(std::move(f)), nullptr));
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		// runs a and b in parallel and returns when both are done
+		// b is pushed where a thief can take it, a runs on the calling thread
+		template <typename FA, typename FB>
+		void fork_join(FA a, FB b)
+		{
+			task_group g(*this);
+			g.run(std::move(b));
+			a();
+			g.wait();
+		}
+
+		// calls f(i) for i in [first, last) by recursive halving down to grain
+		template <typename F>
+		void parallel_for(size_t first, size_t last, size_t grain, const F &f)
+		{
+			if (grain == 0)
+				grain = 1;
+			if (last - first <= grain)
+			{
+				for (size_t i = first; i < last; i++)
+					f(i);
+				return;
+			}
+			size_t mid = first + (last - first) / 2;
+			fork_join([&]() { parallel_for(first, mid, grain, f); },
+					  [&]() { parallel_for(mid, last, grain, f); });
+		}
+	};
+}
+
+#endif
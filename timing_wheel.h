@@ -0,0 +1,310 @@
+#ifndef _CP_TIMING_WHEEL_INCLUDED_
+#define _CP_TIMING_WHEEL_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+//#pragma once
+
+namespace CP
+{
+
+	// hierarchical timing wheel
+	// time advances in ticks; level l has 256 slots of 256^l ticks each. A
+	// timer sits on the level of the highest byte where its expiry tick
+	// differs from now, so schedule and cancel are O(1) list operations and a
+	// timer is moved down at most once per level before it fires. Timers
+	// live in a pool of nodes linked by index; a handle is the node index
+	// plus a generation, so a stale handle is simply ignored
+	template <typename T>
+	class timing_wheel
+	{
+	public:
+		struct handle
+		{
+			size_t index;
+			uint32_t generation;
+		};
+
+	protected:
+		static constexpr size_t SLOT_BITS = 8;
+		static constexpr size_t SLOTS = (size_t)1 << SLOT_BITS;
+		static constexpr size_t NIL = (size_t)-1;
+
+		class node
+		{
+			friend class timing_wheel;
+
+		protected:
+			T value;
+			uint64_t expire; // absolute tick
+			size_t prev;
+			size_t next; // next in slot, or next free node
+			size_t bucket; // NIL while free
+			uint32_t generation;
+
+		public:
+			node() : value(), expire(0), prev(NIL), next(NIL), bucket(NIL), generation(0) {}
+		};
+
+		std::vector<node> mNodes;
+		std::vector<size_t> mHeads; // levels * SLOTS buckets plus one overflow bucket
+		std::vector<size_t> mLevelCount;
+		std::vector<T> mExpired;
+		size_t mFree;
+		size_t mLevels;
+		size_t mSize;
+		uint64_t mNow;
+		std::chrono::nanoseconds mTick;
+		std::chrono::nanoseconds mCarry; // elapsed time short of a full tick
+
+		size_t overflow() const
+		{
+			return mLevels * SLOTS;
+		}
+
+		static uint64_t span(size_t level)
+		{
+			return level * SLOT_BITS >= 64 ? 0 : (uint64_t)1 << (level * SLOT_BITS);
+		}
+
+		size_t bucket_of(uint64_t expire) const
+		{
+			uint64_t diff = expire ^ mNow;
+			size_t level = 0;
+			while (level + 1 < mLevels && (diff >> ((level + 1) * SLOT_BITS)) != 0)
+				level++;
+			if (level + 1 == mLevels && mLevels * SLOT_BITS < 64 && (diff >> (mLevels * SLOT_BITS)) != 0)
+				return overflow();
+			return level * SLOTS + ((expire >> (level * SLOT_BITS)) & (SLOTS - 1));
+		}
+
+		void link(size_t idx)
+		{
+			node &n = mNodes[idx];
+			size_t b = bucket_of(n.expire);
+			n.bucket = b;
+			n.prev = NIL;
+			n.next = mHeads[b];
+			if (n.next != NIL)
+				mNodes[n.next].prev = idx;
+			mHeads[b] = idx;
+			mLevelCount[b / SLOTS]++;
+		}
+
+		void unlink(size_t idx)
+		{
+			node &n = mNodes[idx];
+			if (n.prev != NIL)
+				mNodes[n.prev].next = n.next;
+			else
+				mHeads[n.bucket] = n.next;
+			if (n.next != NIL)
+				mNodes[n.next].prev = n.prev;
+			mLevelCount[n.bucket / SLOTS]--;
+		}
+
+		// detaches a whole bucket, returning its first node
+		size_t take(size_t b)
+		{
+			size_t first = mHeads[b];
+			mHeads[b] = NIL;
+			for (size_t i = first; i != NIL; i = mNodes[i].next)
+				mLevelCount[b / SLOTS]--;
+			return first;
+		}
+
+		void release(size_t idx)
+		{
+			node &n = mNodes[idx];
+			n.bucket = NIL;
+			n.generation++;
+			n.next = mFree;
+			mFree = idx;
+			mSize--;
+		}
+
+		void cascade(size_t b)
+		{
+			size_t i = take(b);
+			while (i != NIL)
+			{
+				size_t next = mNodes[i].next;
+				link(i);
+				i = next;
+			}
+		}
+
+		// moves the wheel to tick t: higher levels whose window starts at t
+		// are spread over the lower ones, then level 0 fires
+		void step(uint64_t t)
+		{
+			mNow = t;
+			if (mLevels * SLOT_BITS < 64 && (t & (span(mLevels) - 1)) == 0)
+				cascade(overflow());
+			for (size_t l = mLevels - 1; l >= 1; l--)
+			{
+				if ((t & (span(l) - 1)) == 0)
+					cascade(l * SLOTS + ((t >> (l * SLOT_BITS)) & (SLOTS - 1)));
+			}
+			size_t i = take(t & (SLOTS - 1));
+			while (i != NIL)
+			{
+				size_t next = mNodes[i].next;
+				mExpired.push_back(std::move(mNodes[i].value));
+				release(i);
+				i = next;
+			}
+		}
+
+		// the next tick after mNow at which anything can happen
+		uint64_t next_event() const
+		{
+			if (mLevelCount[0] != 0)
+				return mNow + 1;
+			for (size_t l = 1; l <= mLevels; l++)
+			{
+				if (mLevelCount[l] != 0)
+				{
+					uint64_t s = span(l);
+					return (mNow | (s - 1)) + 1;
+				}
+			}
+			return UINT64_MAX;
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// levels wheels of 256 slots cover 256^levels ticks, later timers wait
+		// in an overflow list that is revisited once per full rotation
+		timing_wheel(std::chrono::nanoseconds tick = std::chrono::milliseconds(1), size_t levels = 4)
+			: mFree(NIL), mLevels(levels), mSize(0), mNow(0), mTick(tick), mCarry(0)
+		{
+			if (tick.count() <= 0)
+				throw std::invalid_argument("timing_wheel tick must be positive");
+			if (levels < 1 || levels * SLOT_BITS > 64)
+				throw std::invalid_argument("timing_wheel needs 1 to 8 levels");
+			mHeads.assign(mLevels * SLOTS + 1, NIL);
+			mLevelCount.assign(mLevels + 1, 0);
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		//----------------- access -----------------
+		std::chrono::nanoseconds tick() const
+		{
+			return mTick;
+		}
+
+		// time since construction, in whole ticks
+		std::chrono::nanoseconds now() const
+		{
+			return mTick * mNow;
+		}
+
+		bool pending(handle h) const
+		{
+			return h.index < mNodes.size() && mNodes[h.index].generation == h.generation &&
+				   mNodes[h.index].bucket != NIL;
+		}
+
+		//----------------- modifier -------------
+		// fires after delay, rounded up to whole ticks (at least one)
+		template <typename Rep, typename Period>
+		handle schedule(std::chrono::duration<Rep, Period> delay, const T &value)
+		{
+			long long d = std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count();
+			uint64_t ticks = d <= 0 ? 1 : (uint64_t)((d + mTick.count() - 1) / mTick.count());
+			size_t idx;
+			if (mFree != NIL)
+			{
+				idx = mFree;
+				mFree = mNodes[idx].next;
+			}
+			else
+			{
+				idx = mNodes.size();
+				mNodes.push_back(node());
+			}
+			node &n = mNodes[idx];
+			n.value = value;
+			n.expire = mNow + ticks;
+			link(idx);
+			mSize++;
+			return handle{idx, n.generation};
+		}
+
+		// false when the timer already fired or was cancelled
+		bool cancel(handle h)
+		{
+			if (!pending(h))
+				return false;
+			unlink(h.index);
+			release(h.index);
+			return true;
+		}
+
+		// moves time forward and hands every expired value to callback, tick
+		// by tick; timers due on the same tick come in no particular order.
+		// The callback may schedule or cancel timers
+		template <typename Callback>
+		size_t advance(std::chrono::nanoseconds elapsed, Callback callback)
+		{
+			if (elapsed.count() > 0)
+				mCarry += elapsed;
+			uint64_t target = mNow + (uint64_t)(mCarry / mTick);
+			mCarry %= mTick;
+			size_t fired = 0;
+			while (mNow < target)
+			{
+				uint64_t t = next_event();
+				if (t > target)
+				{
+					mNow = target;
+					break;
+				}
+				step(t);
+				if (!mExpired.empty())
+				{
+					std::vector<T> batch;
+					batch.swap(mExpired);
+					for (T &v : batch)
+						callback(v);
+					fired += batch.size();
+				}
+			}
+			return fired;
+		}
+
+		// the nodes are kept and released like cancelled timers, so their
+		// generations move on and handles taken before stay stale
+		void clear()
+		{
+			for (size_t i = 0; i < mNodes.size(); i++)
+			{
+				if (mNodes[i].bucket != NIL)
+				{
+					mNodes[i].value = T();
+					release(i);
+				}
+			}
+			mHeads.assign(mLevels * SLOTS + 1, NIL);
+			mLevelCount.assign(mLevels + 1, 0);
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef _CP_TOPK_INCLUDED_
+#define _CP_TOPK_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <functional>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <type_traits>
+//#pragma once
+
+namespace CP
+{
+
+	// keeps the K largest elements (under Comp) of a stream
+	// the elements are held in a heap with the worst kept element at the root,
+	// so an element that does not beat threshold() is rejected with a single
+	// comparison and only qualifying elements pay for a sift
+	template <typename T, typename Comp = std::less<T>>
+	class topk
+	{
+	protected:
+		std::vector<T> mData;
+		size_t mK;
+		Comp mLess;
+
+		// blocks of offer_range() are first tested against the threshold with
+		// a branch-free reduction when the comparison is the plain < or > of
+		// an arithmetic type
+		static const bool SIMD_FILTER = std::is_arithmetic<T>::value &&
+										(std::is_same<Comp, std::less<T>>::value || std::is_same<Comp, std::greater<T>>::value);
+		static const size_t BLOCK = 16;
+
+		// min-heap under mLess: a parent is never better than its children
+		void fixUp(size_t idx)
+		{
+			T tmp = mData[idx];
+			while (idx > 0)
+			{
+				size_t p = (idx - 1) / 2;
+				if (!mLess(tmp, mData[p]))
+					break;
+				mData[idx] = mData[p];
+				idx = p;
+			}
+			mData[idx] = tmp;
+		}
+
+		void fixDown(size_t idx)
+		{
+			T tmp = mData[idx];
+			size_t n = mData.size();
+			size_t c;
+			while ((c = 2 * idx + 1) < n)
+			{
+				if (c + 1 < n && mLess(mData[c + 1], mData[c]))
+					c++;
+				if (!mLess(mData[c], tmp))
+					break;
+				mData[idx] = mData[c];
+				idx = c;
+			}
+			mData[idx] = tmp;
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		topk(size_t k, const Comp &c = Comp()) : mK(k), mLess(c)
+		{
+			mData.reserve(k);
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mData.empty();
+		}
+
+		size_t size() const
+		{
+			return mData.size();
+		}
+
+		size_t capacity() const
+		{
+			return mK;
+		}
+
+		bool full() const
+		{
+			return mData.size() == mK;
+		}
+
+		//----------------- access -----------------
+		// the worst element kept, an element must beat it to get in
+		const T &threshold() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mData[0];
+		}
+
+		// the kept elements, best first
+		std::vector<T> sorted_result() const
+		{
+			std::vector<T> res(mData);
+			std::sort(res.begin(), res.end(), [this](const T &a, const T &b)
+					  { return mLess(b, a); });
+			return res;
+		}
+
+		//----------------- modifier -------------
+		// true when the element was kept
+		bool offer(const T &element)
+		{
+			if (mData.size() < mK)
+			{
+				mData.push_back(element);
+				fixUp(mData.size() - 1);
+				return true;
+			}
+			if (mK == 0 || !mLess(mData[0], element))
+				return false;
+			mData[0] = element;
+			fixDown(0);
+			return true;
+		}
+
+		// returns the number of elements kept
+		template <typename InputIt>
+		size_t offer_range(InputIt first, InputIt last)
+		{
+			size_t kept = 0;
+			for (; first != last && mData.size() < mK; ++first)
+				kept += offer(*first);
+			if constexpr (SIMD_FILTER && std::is_base_of<std::random_access_iterator_tag,
+														 typename std::iterator_traits<InputIt>::iterator_category>::value)
+			{
+				while (mK > 0 && last - first >= (std::ptrdiff_t)BLOCK)
+				{
+					// one pass over the block without branches; most blocks
+					// hold nothing better than the threshold and are skipped
+					T t = mData[0];
+					bool any = false;
+					for (size_t i = 0; i < BLOCK; i++)
+						any |= mLess(t, first[i]);
+					if (any)
+					{
+						for (size_t i = 0; i < BLOCK; i++)
+							kept += offer(first[i]);
+					}
+					first += BLOCK;
+				}
+			}
+			for (; first != last; ++first)
+				kept += offer(*first);
+			return kept;
+		}
+
+		void clear()
+		{
+			mData.clear();
+		}
+	};
+}
+
+#endif
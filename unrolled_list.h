@@ -0,0 +1,526 @@
+#ifndef _CP_UNROLLED_LIST_INCLUDED_
+#define _CP_UNROLLED_LIST_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <utility>
+//#pragma once
+
+namespace CP
+{
+
+	// doubly linked list of small arrays
+	// same interface as CP::list, but every node holds up to B elements, so
+	// a traversal touches one node per B elements. A full node is split in
+	// half on insert and a node that runs low on erase absorbs its successor
+	// when both fit in one. Splicing moves whole nodes and splits at most
+	// the node at the cut. Unlike CP::list, insert and erase invalidate the
+	// iterators into the node they touch
+	template <typename T, size_t B = 32>
+	class unrolled_list
+	{
+		static_assert(B >= 2, "unrolled_list needs at least two elements per node");
+
+	protected:
+		class link
+		{
+		public:
+			link *prev;
+			link *next;
+			size_t count; // always 0 for the header
+
+			link() : prev(this), next(this), count(0) {}
+		};
+
+		class node : public link
+		{
+		public:
+			T data[B];
+		};
+
+		static node *as_node(link *l)
+		{
+			return static_cast<node *>(l);
+		}
+
+		class unrolled_list_iterator
+		{
+			friend class unrolled_list;
+
+		protected:
+			link *ptr;
+			size_t idx;
+
+		public:
+			unrolled_list_iterator() : ptr(nullptr), idx(0) {}
+
+			unrolled_list_iterator(link *a, size_t i) : ptr(a), idx(i) {}
+
+			unrolled_list_iterator &operator++()
+			{
+				if (++idx >= ptr->count)
+				{
+					ptr = ptr->next;
+					idx = 0;
+				}
+				return (*this);
+			}
+
+			unrolled_list_iterator &operator--()
+			{
+				if (idx == 0)
+				{
+					ptr = ptr->prev;
+					idx = ptr->count - 1;
+				}
+				else
+					idx--;
+				return (*this);
+			}
+
+			unrolled_list_iterator operator++(int)
+			{
+				unrolled_list_iterator tmp(*this);
+				operator++();
+				return tmp;
+			}
+
+			unrolled_list_iterator operator--(int)
+			{
+				unrolled_list_iterator tmp(*this);
+				operator--();
+				return tmp;
+			}
+
+			T &operator*() { return as_node(ptr)->data[idx]; }
+			T *operator->() { return &(as_node(ptr)->data[idx]); }
+			bool operator==(const unrolled_list_iterator &other) { return other.ptr == ptr && other.idx == idx; }
+			bool operator!=(const unrolled_list_iterator &other) { return !(*this == other); }
+		};
+
+	public:
+		typedef unrolled_list_iterator iterator;
+
+	protected:
+		link *mHeader; // pointer to a header node
+		size_t mSize;
+
+		// links n in front of before
+		static void link_before(link *n, link *before)
+		{
+			n->prev = before->prev;
+			n->next = before;
+			before->prev->next = n;
+			before->prev = n;
+		}
+
+		static void unlink(link *n)
+		{
+			n->prev->next = n->next;
+			n->next->prev = n->prev;
+		}
+
+		// moves the nodes first..last (inclusive) in front of before
+		static void splice_nodes(link *first, link *last, link *before)
+		{
+			first->prev->next = last->next;
+			last->next->prev = first->prev;
+			first->prev = before->prev;
+			last->next = before;
+			before->prev->next = first;
+			before->prev = last;
+		}
+
+		// makes position i of n the start of a node, returns that node
+		link *split_node(link *n, size_t i)
+		{
+			if (i == 0)
+				return n;
+			if (i >= n->count)
+				return n->next;
+			node *m = new node();
+			node *src = as_node(n);
+			for (size_t j = i; j < n->count; j++)
+				m->data[j - i] = std::move(src->data[j]);
+			m->count = n->count - i;
+			n->count = i;
+			link_before(m, n->next);
+			return m;
+		}
+
+		// node and offset of element pos, the header when pos == mSize
+		std::pair<link *, size_t> locate(size_t pos) const
+		{
+			link *n = mHeader->next;
+			while (n != mHeader && pos >= n->count)
+			{
+				pos -= n->count;
+				n = n->next;
+			}
+			return std::make_pair(n, n == mHeader ? 0 : pos);
+		}
+
+		// a small node absorbs its successor when both fit in one node
+		void try_merge(link *n)
+		{
+			link *next = n->next;
+			if (n == mHeader || next == mHeader || n->count + next->count > B)
+				return;
+			node *a = as_node(n);
+			node *b = as_node(next);
+			for (size_t j = 0; j < b->count; j++)
+				a->data[a->count + j] = std::move(b->data[j]);
+			a->count += b->count;
+			unlink(next);
+			delete b;
+		}
+
+		void delete_all_nodes()
+		{
+			link *n = mHeader->next;
+			while (n != mHeader)
+			{
+				link *next = n->next;
+				delete as_node(n);
+				n = next;
+			}
+			mHeader->next = mHeader->prev = mHeader;
+		}
+
+		// moves every node of other to the end of this list
+		void append_nodes(unrolled_list<T, B> &other)
+		{
+			if (other.mSize == 0)
+				return;
+			splice_nodes(other.mHeader->next, other.mHeader->prev, mHeader);
+			mSize += other.mSize;
+			other.mSize = 0;
+		}
+
+	public:
+		//-------------- constructor & copy operator ----------
+
+		// copy constructor
+		unrolled_list(const unrolled_list<T, B> &a) : mHeader(new link()), mSize(0)
+		{
+			for (link *n = a.mHeader->next; n != a.mHeader; n = n->next)
+			{
+				node *m = new node();
+				for (size_t j = 0; j < n->count; j++)
+					m->data[j] = as_node(n)->data[j];
+				m->count = n->count;
+				link_before(m, mHeader);
+				mSize += n->count;
+			}
+		}
+
+		// default constructor
+		unrolled_list() : mHeader(new link()), mSize(0) {}
+
+		// copy assignment operator using copy-and-swap idiom
+		unrolled_list<T, B> &operator=(unrolled_list<T, B> other)
+		{
+			using std::swap;
+			swap(this->mHeader, other.mHeader);
+			swap(this->mSize, other.mSize);
+			return *this;
+		}
+
+		~unrolled_list()
+		{
+			delete_all_nodes();
+			delete mHeader;
+		}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mSize == 0;
+		}
+
+		size_t size() const
+		{
+			return mSize;
+		}
+
+		//----------------- iterator ---------------
+		iterator begin()
+		{
+			return iterator(mHeader->next, 0);
+		}
+
+		iterator end()
+		{
+			return iterator(mHeader, 0);
+		}
+
+		//----------------- access -----------------
+		T &front() { return as_node(mHeader->next)->data[0]; }
+
+		T &back() { return as_node(mHeader->prev)->data[mHeader->prev->count - 1]; }
+
+		//----------------- modifier -------------
+		void push_back(const T &element)
+		{
+			insert(end(), element);
+		}
+
+		void push_front(const T &element)
+		{
+			insert(begin(), element);
+		}
+
+		void pop_back()
+		{
+			erase(iterator(mHeader->prev, mHeader->prev->count - 1));
+		}
+
+		void pop_front()
+		{
+			erase(begin());
+		}
+
+		iterator insert(iterator it, const T &element)
+		{
+			link *n = it.ptr;
+			size_t i = it.idx;
+			if (n == mHeader)
+			{
+				// append to the last node while it has room
+				n = mHeader->prev;
+				if (n == mHeader || n->count == B)
+				{
+					n = new node();
+					link_before(n, mHeader);
+				}
+				i = n->count;
+			}
+			else if (n->count == B)
+			{
+				link *m = split_node(n, B / 2);
+				if (i > n->count)
+				{
+					i -= n->count;
+					n = m;
+				}
+			}
+			node *d = as_node(n);
+			for (size_t j = n->count; j > i; j--)
+				d->data[j] = std::move(d->data[j - 1]);
+			d->data[i] = element;
+			n->count++;
+			mSize++;
+			return iterator(n, i);
+		}
+
+		iterator erase(iterator it)
+		{
+			link *n = it.ptr;
+			size_t i = it.idx;
+			node *d = as_node(n);
+			for (size_t j = i; j + 1 < n->count; j++)
+				d->data[j] = std::move(d->data[j + 1]);
+			n->count--;
+			mSize--;
+			if (n->count == 0)
+			{
+				link *next = n->next;
+				unlink(n);
+				delete d;
+				return iterator(next, 0);
+			}
+			if (n->count <= B / 4)
+				try_merge(n);
+			if (i < n->count)
+				return iterator(n, i);
+			return iterator(n->next, 0);
+		}
+
+		void clear()
+		{
+			delete_all_nodes();
+			mSize = 0;
+		}
+
+		void print()
+		{
+			std::cout << " Size = " << mSize << std::endl;
+			int i = 0;
+			for (link *n = mHeader->next; n != mHeader; n = n->next, i++)
+			{
+				std::cout << "Node " << i << " (" << n->count << "):";
+				for (size_t j = 0; j < n->count; j++)
+					std::cout << " " << as_node(n)->data[j];
+				std::cout << std::endl;
+			}
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		// moves the elements at the increasing indices in selected, in that
+		// order, in front of the element at pos
+		void reorder(int pos, std::vector<int> selected)
+		{
+			std::vector<T> out;
+			out.reserve(mSize);
+			std::vector<T> moved;
+			size_t s = 0, idx = 0;
+			for (iterator it = begin(); it != end(); ++it, ++idx)
+			{
+				if (s < selected.size() && (size_t)selected[s] == idx)
+				{
+					moved.push_back(*it);
+					s++;
+				}
+			}
+			s = 0;
+			idx = 0;
+			for (iterator it = begin(); it != end(); ++it, ++idx)
+			{
+				if (idx == (size_t)pos)
+					out.insert(out.end(), moved.begin(), moved.end());
+				if (s < selected.size() && (size_t)selected[s] == idx)
+					s++;
+				else
+					out.push_back(*it);
+			}
+			if ((size_t)pos >= mSize)
+				out.insert(out.end(), moved.begin(), moved.end());
+			size_t k = 0;
+			for (iterator it = begin(); it != end(); ++it)
+				*it = out[k++];
+		}
+
+		// moves every element equal to value in [a, b) to the front of output;
+		// value is copied first since erasing shifts elements under it
+		void extract(const T &value, iterator a, iterator b, CP::unrolled_list<T, B> &output)
+		{
+			if (&output == this)
+				return;
+			const T v(value);
+			size_t n = 0;
+			for (iterator it = a; it != b; ++it)
+				n++;
+			iterator it = a;
+			for (size_t k = 0; k < n; k++)
+			{
+				if (*it == v)
+				{
+					output.push_front(*it);
+					it = erase(it);
+				}
+				else
+					++it;
+			}
+		}
+
+		iterator reverse(iterator a, iterator b)
+		{
+			if (mSize == 0 || a == b)
+				return a;
+			auto ait = a, bit = b;
+			--bit;
+			while (ait != bit)
+			{
+				std::swap(*ait, *bit);
+				++ait;
+				if (ait == bit)
+					break;
+				--bit;
+			}
+			return a;
+		}
+
+		void shift_left()
+		{
+			shift(1);
+		}
+
+		// first (size + 1) / 2 elements to the end of list1, the rest to list2
+		void splitList(CP::unrolled_list<T, B> &list1, CP::unrolled_list<T, B> &list2)
+		{
+			if (mSize == 0)
+				return;
+			size_t n = (mSize + 1) / 2;
+			std::pair<link *, size_t> p = locate(n);
+			link *cut = split_node(p.first, p.second);
+			if (cut != mHeader)
+				splice_nodes(cut, mHeader->prev, list2.mHeader);
+			splice_nodes(mHeader->next, mHeader->prev, list1.mHeader);
+			list1.mSize += n;
+			list2.mSize += mSize - n;
+			mSize = 0;
+		}
+
+		// value is copied first since compaction overwrites the slots
+		void remove_all(const T &value)
+		{
+			const T v(value);
+			link *n = mHeader->next;
+			while (n != mHeader)
+			{
+				node *d = as_node(n);
+				size_t w = 0;
+				for (size_t j = 0; j < n->count; j++)
+				{
+					if (!(d->data[j] == v))
+					{
+						if (w != j)
+							d->data[w] = std::move(d->data[j]);
+						w++;
+					}
+				}
+				mSize -= n->count - w;
+				n->count = w;
+				link *next = n->next;
+				if (w == 0)
+				{
+					unlink(n);
+					delete d;
+				}
+				n = next;
+			}
+		}
+
+		// elements from it (at index pos) to the end move to the result
+		CP::unrolled_list<T, B> split(iterator it, size_t pos)
+		{
+			CP::unrolled_list<T, B> result;
+			if (it == end())
+				return result;
+			link *cut = split_node(it.ptr, it.idx);
+			splice_nodes(cut, mHeader->prev, result.mHeader);
+			result.mSize = mSize - pos;
+			mSize = pos;
+			return result;
+		}
+
+		// rotates left by k: element k becomes the front
+		void shift(int k)
+		{
+			if (mSize == 0)
+				return;
+			int s = mSize;
+			k = k % s;
+			if (k < 0)
+				k = (s + k) % s;
+			if (k == 0)
+				return;
+			std::pair<link *, size_t> p = locate(k);
+			link *cut = split_node(p.first, p.second);
+			// the header moves in front of cut
+			unlink(mHeader);
+			link_before(mHeader, cut);
+		}
+
+		// moves every element of each list in ls to the end of this list
+		template <typename ListOfLists>
+		void merge(ListOfLists &ls)
+		{
+			for (auto &x : ls)
+				append_nodes(x);
+		}
+	};
+}
+
+#endif
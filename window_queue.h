@@ -0,0 +1,244 @@
+#ifndef _CP_WINDOW_QUEUE_INCLUDED_
+#define _CP_WINDOW_QUEUE_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <deque>
+#include <utility>
+//#pragma once
+
+namespace CP
+{
+
+	template <typename T, template <typename> class... Ops>
+	class window_queue;
+
+	// aggregates for window_queue, each one is updated in amortized O(1)
+	// on push and pop and answers its query in O(1)
+
+	// sliding minimum using a monotonic deque of (value, sequence number)
+	template <typename T>
+	class window_min
+	{
+		template <typename, template <typename> class...>
+		friend class window_queue;
+
+	protected:
+		std::deque<std::pair<T, size_t>> mMin;
+
+		void on_push(const T &x, size_t seq)
+		{
+			while (!mMin.empty() && x < mMin.back().first)
+				mMin.pop_back();
+			mMin.push_back(std::make_pair(x, seq));
+		}
+
+		void on_pop(const T &, size_t seq)
+		{
+			if (mMin.front().second == seq)
+				mMin.pop_front();
+		}
+
+		void on_clear()
+		{
+			mMin.clear();
+		}
+
+	public:
+		const T &min() const
+		{
+			if (mMin.empty())
+				throw std::out_of_range("index of out range");
+			return mMin.front().first;
+		}
+	};
+
+	// sliding maximum using a monotonic deque of (value, sequence number)
+	template <typename T>
+	class window_max
+	{
+		template <typename, template <typename> class...>
+		friend class window_queue;
+
+	protected:
+		std::deque<std::pair<T, size_t>> mMax;
+
+		void on_push(const T &x, size_t seq)
+		{
+			while (!mMax.empty() && mMax.back().first < x)
+				mMax.pop_back();
+			mMax.push_back(std::make_pair(x, seq));
+		}
+
+		void on_pop(const T &, size_t seq)
+		{
+			if (mMax.front().second == seq)
+				mMax.pop_front();
+		}
+
+		void on_clear()
+		{
+			mMax.clear();
+		}
+
+	public:
+		const T &max() const
+		{
+			if (mMax.empty())
+				throw std::out_of_range("index of out range");
+			return mMax.front().first;
+		}
+	};
+
+	// running sum and count
+	template <typename T>
+	class window_sum
+	{
+		template <typename, template <typename> class...>
+		friend class window_queue;
+
+	protected:
+		T mSum;
+		size_t mCount;
+
+		window_sum() : mSum(T()), mCount(0) {}
+
+		void on_push(const T &x, size_t)
+		{
+			mSum += x;
+			mCount++;
+		}
+
+		void on_pop(const T &x, size_t)
+		{
+			mSum -= x;
+			mCount--;
+		}
+
+		void on_clear()
+		{
+			mSum = T();
+			mCount = 0;
+		}
+
+	public:
+		T sum() const
+		{
+			return mSum;
+		}
+
+		double mean() const
+		{
+			if (mCount == 0)
+				throw std::out_of_range("index of out range");
+			return (double)mSum / (double)mCount;
+		}
+	};
+
+	// FIFO window with O(1) aggregates
+	// e.g. CP::window_queue<double, CP::window_min, CP::window_max, CP::window_sum>
+	// every element carries an optional timestamp used by evict_before()
+	template <typename T, template <typename> class... Ops>
+	class window_queue : public Ops<T>...
+	{
+	protected:
+		std::deque<std::pair<T, long long>> mData;
+		size_t mSeq; // sequence number of the next element to be pushed
+
+	public:
+		//-------------- constructor ----------
+		window_queue() : mSeq(0) {}
+
+		//------------- capacity function -------------------
+		bool empty() const
+		{
+			return mData.empty();
+		}
+
+		size_t size() const
+		{
+			return mData.size();
+		}
+
+		//----------------- access -----------------
+		const T &front() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mData.front().first;
+		}
+
+		const T &back() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mData.back().first;
+		}
+
+		long long front_time() const
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			return mData.front().second;
+		}
+
+		//----------------- modifier -------------
+		void push(const T &element, long long timestamp = 0)
+		{
+			mData.push_back(std::make_pair(element, timestamp));
+			(Ops<T>::on_push(element, mSeq), ...);
+			mSeq++;
+		}
+
+		void pop()
+		{
+			if (size() == 0)
+				throw std::out_of_range("index of out range");
+			size_t seq = mSeq - mData.size();
+			const T &x = mData.front().first;
+			(Ops<T>::on_pop(x, seq), ...);
+			mData.pop_front();
+		}
+
+		void clear()
+		{
+			mData.clear();
+			(Ops<T>::on_clear(), ...);
+		}
+
+		//-------------- extra (unlike STL) ------------------
+		// pops every element older than timestamp, returns how many were removed
+		size_t evict_before(long long timestamp)
+		{
+			size_t n = 0;
+			while (!mData.empty() && mData.front().second < timestamp)
+			{
+				pop();
+				n++;
+			}
+			return n;
+		}
+
+		// pops from the front while pred(value, timestamp) holds
+		template <typename Pred>
+		size_t evict_while(Pred pred)
+		{
+			size_t n = 0;
+			while (!mData.empty() && pred(mData.front().first, mData.front().second))
+			{
+				pop();
+				n++;
+			}
+			return n;
+		}
+
+		// keeps only the newest k elements
+		void trim(size_t k)
+		{
+			while (mData.size() > k)
+				pop();
+		}
+	};
+}
+
+#endif
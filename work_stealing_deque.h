@@ -0,0 +1,173 @@
+#ifndef _CP_WORK_STEALING_DEQUE_INCLUDED_
+#define _CP_WORK_STEALING_DEQUE_INCLUDED_
+
+#include <stdexcept>
+#include <iostream>
+#include <atomic>
+#include <vector>
+#include <type_traits>
+//#pragma once
+
+namespace CP
+{
+
+	// Chase-Lev work-stealing deque
+	// the owner thread pushes and pops at the bottom, any other thread may
+	// steal from the top without a lock. T must be trivially copyable
+	// (normally a pointer to a task)
+	template <typename T>
+	class work_stealing_deque
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "work_stealing_deque needs a trivially copyable T");
+
+	protected:
+		// ring buffer indexed the same way as CP::queue, but with a power of two
+		// capacity so that (pos % mCap) becomes (pos & mMask)
+		class ring
+		{
+		public:
+			size_t mCap;
+			size_t mMask;
+			std::atomic<T> *mData;
+
+			ring(size_t capacity) : mCap(capacity), mMask(capacity - 1), mData(new std::atomic<T>[capacity]) {}
+
+			~ring()
+			{
+				delete[] mData;
+			}
+
+			T get(long long i) const
+			{
+				return mData[(size_t)i & mMask].load(std::memory_order_relaxed);
+			}
+
+			void put(long long i, T x)
+			{
+				mData[(size_t)i & mMask].store(x, std::memory_order_relaxed);
+			}
+
+			ring *expand(long long bottom, long long top) const
+			{
+				ring *r = new ring(mCap * 2);
+				for (long long i = top; i < bottom; i++)
+				{
+					r->put(i, get(i));
+				}
+				return r;
+			}
+		};
+
+		alignas(64) std::atomic<long long> mTop;
+		alignas(64) std::atomic<long long> mBottom;
+		std::atomic<ring *> mArray;
+		// old rings may still be read by a concurrent thief, so they are only
+		// freed together with the deque
+		std::vector<ring *> mRetired;
+
+		static size_t round_up(size_t capacity)
+		{
+			size_t c = 2;
+			while (c < capacity)
+				c <<= 1;
+			return c;
+		}
+
+	public:
+		//-------------- constructor ----------
+
+		// default constructor
+		work_stealing_deque(size_t capacity = 64) : mTop(0), mBottom(0), mArray(new ring(round_up(capacity))) {}
+
+		work_stealing_deque(const work_stealing_deque<T> &) = delete;
+		work_stealing_deque<T> &operator=(const work_stealing_deque<T> &) = delete;
+
+		~work_stealing_deque()
+		{
+			for (ring *r : mRetired)
+				delete r;
+			delete mArray.load(std::memory_order_relaxed);
+		}
+
+		//------------- capacity function -------------------
+		// only a snapshot while thieves are running
+		bool empty() const
+		{
+			return size() == 0;
+		}
+
+		size_t size() const
+		{
+			long long b = mBottom.load(std::memory_order_relaxed);
+			long long t = mTop.load(std::memory_order_relaxed);
+			return b > t ? (size_t)(b - t) : 0;
+		}
+
+		size_t capacity() const
+		{
+			return mArray.load(std::memory_order_relaxed)->mCap;
+		}
+
+		//----------------- modifier -------------
+		// owner only
+		void push(T element)
+		{
+			long long b = mBottom.load(std::memory_order_relaxed);
+			long long t = mTop.load(std::memory_order_acquire);
+			ring *a = mArray.load(std::memory_order_relaxed);
+			if (b - t > (long long)a->mCap - 1)
+			{
+				ring *bigger = a->expand(b, t);
+				mRetired.push_back(a);
+				mArray.store(bigger, std::memory_order_release);
+				a = bigger;
+			}
+			a->put(b, element);
+			std::atomic_thread_fence(std::memory_order_release);
+			mBottom.store(b + 1, std::memory_order_relaxed);
+		}
+
+		// owner only, takes the most recently pushed element
+		bool pop(T &out)
+		{
+			long long b = mBottom.load(std::memory_order_relaxed) - 1;
+			ring *a = mArray.load(std::memory_order_relaxed);
+			mBottom.store(b, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			long long t = mTop.load(std::memory_order_relaxed);
+			if (t > b)
+			{
+				// empty
+				mBottom.store(b + 1, std::memory_order_relaxed);
+				return false;
+			}
+			out = a->get(b);
+			if (t == b)
+			{
+				// last element, race against thieves for it
+				bool won = mTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+				mBottom.store(b + 1, std::memory_order_relaxed);
+				return won;
+			}
+			return true;
+		}
+
+		// any thread, takes the oldest element
+		bool steal(T &out)
+		{
+			long long t = mTop.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			long long b = mBottom.load(std::memory_order_acquire);
+			if (t >= b)
+				return false;
+			ring *a = mArray.load(std::memory_order_acquire);
+			T x = a->get(t);
+			if (!mTop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return false; // lost the race to another thief or the owner
+			out = x;
+			return true;
+		}
+	};
+}
+
+#endif